@@ -30,6 +30,7 @@
 #include "../Engine/RNG.h"
 #include "../Engine/Logger.h"
 #include "../Engine/Game.h"
+#include "../Engine/ThreadPool.h"
 #include "../Mod/Armor.h"
 #include "../Mod/Mod.h"
 #include "../Mod/RuleItem.h"
@@ -675,6 +676,18 @@ void AIModule::setupPatrol()
 	}
 }
 
+/**
+ * Gets number of candidate positions checked at once on worker threads.
+ * Searches stop early on good enough position, so with only one worker
+ * each position is checked separately, same as a serial loop.
+ * @return Size of chunk.
+ */
+static size_t getCandidateChunk()
+{
+	const size_t workers = ThreadPool::getShared().getWorkerCount();
+	return workers > 1 ? workers * 4 : 1;
+}
+
 /**
  * Try to set up an ambush action
  * The idea is to check within a 11x11 tile square for a tile which is not seen by our aggroTarget,
@@ -697,6 +710,7 @@ void AIModule::setupAmbush()
 		Position origin = _save->getTileEngine()->getSightOriginVoxel(_aggroTarget);
 
 		// we'll use node positions for this, as it gives map makers a good degree of control over how the units will use the environment.
+		std::vector<Position> candidates;
 		for (std::vector<Node*>::const_iterator i = _save->getNodes()->begin(); i != _save->getNodes()->end(); ++i)
 		{
 			if ((*i)->isDummy())
@@ -715,10 +729,33 @@ void AIModule::setupAmbush()
 				tile->setPreview(10);
 				tile->setMarkerColor(13);
 			}
+			candidates.push_back(pos);
+		}
 
-			// make sure we can't be seen here.
-			Position target;
-			if (!_save->getTileEngine()->canTargetUnit(&origin, tile, &target, _aggroTarget, false, _unit) && !getSpottingUnits(pos))
+		// make sure we can't be seen here, visibility checks only read map, they can be done for a chunk of nodes at once,
+		// chunks keep early exit below, with one worker each chunk is one node like serial loop.
+		std::vector<Uint8> hidden(candidates.size());
+		const size_t chunk = getCandidateChunk();
+		size_t checked = 0;
+		bool done = false;
+
+		for (size_t i = 0; i < candidates.size() && !done; ++i)
+		{
+			if (i == checked)
+			{
+				checked = std::min(candidates.size(), i + chunk);
+				ThreadPool::getShared().parallelFor(checked - i,
+					[&](size_t j, size_t)
+					{
+						Position pos = candidates[i + j];
+						Position target;
+						hidden[i + j] = !_save->getTileEngine()->canTargetUnit(&origin, _save->getTile(pos), &target, _aggroTarget, false, _unit) && !getSpottingUnits(pos);
+					}
+				);
+			}
+
+			Position pos = candidates[i];
+			if (hidden[i])
 			{
 				_save->getPathfinding()->calculate(_unit, pos, BAM_NORMAL);
 				int ambushTUs = _save->getPathfinding()->getTotalTUCost();
@@ -746,7 +783,7 @@ void AIModule::setupAmbush()
 							_ambushAction.target = pos;
 							if (bestScore > FAST_PASS_THRESHOLD)
 							{
-								break;
+								done = true;
 							}
 						}
 					}
@@ -1825,13 +1862,15 @@ bool AIModule::findFirePoint()
 		return false;
 	std::vector<Position> randomTileSearch = _save->getTileSearch();
 	RNG::shuffle(randomTileSearch);
-	Position target;
 	const int BASE_SYSTEMATIC_SUCCESS = 100;
 	const int FAST_PASS_THRESHOLD = 125;
 	bool waitIfOutsideWeaponRange = _unit->getGeoscapeSoldier() ? false : _unit->getUnitRules()->waitIfOutsideWeaponRange();
 	bool extendedFireModeChoiceEnabled = _save->getBattleGame()->getMod()->getAIExtendedFireModeChoice();
 	int bestScore = 0;
 	_attackAction.type = BA_RETHINK;
+
+	// reachable positions in search order
+	std::vector<Position> candidates;
 	for (std::vector<Position>::const_iterator i = randomTileSearch.begin(); i != randomTileSearch.end(); ++i)
 	{
 		Position pos = _unit->getPosition() + *i;
@@ -1839,13 +1878,38 @@ bool AIModule::findFirePoint()
 		if (tile == 0  ||
 			std::find(_reachableWithAttack.begin(), _reachableWithAttack.end(), _save->getTileIndex(pos))  == _reachableWithAttack.end())
 			continue;
+		candidates.push_back(pos);
+	}
+
+	// line of fire checks only read map, they can be done for a chunk of positions at once, chunks keep early exit below.
+	std::vector<Uint8> canTarget(candidates.size());
+	const size_t chunk = getCandidateChunk();
+	size_t checked = 0;
+
+	for (size_t i = 0; i < candidates.size(); ++i)
+	{
+		if (i == checked)
+		{
+			checked = std::min(candidates.size(), i + chunk);
+			ThreadPool::getShared().parallelFor(checked - i,
+				[&](size_t j, size_t)
+				{
+					Position pos = candidates[i + j];
+					Position target;
+					// i should really make a function for this
+					Position origin = pos.toVoxel() +
+						// 4 because -2 is eyes and 2 below that is the rifle (or at least that's my understanding)
+						Position(8,8, _unit->getHeight() + _unit->getFloatHeight() - _save->getTile(pos)->getTerrainLevel() - 4);
+
+					canTarget[i + j] = _save->getTileEngine()->canTargetUnit(&origin, _aggroTarget->getTile(), &target, _unit, false);
+				}
+			);
+		}
+
+		Position pos = candidates[i];
 		int score = 0;
-		// i should really make a function for this
-		Position origin = pos.toVoxel() +
-			// 4 because -2 is eyes and 2 below that is the rifle (or at least that's my understanding)
-			Position(8,8, _unit->getHeight() + _unit->getFloatHeight() - tile->getTerrainLevel() - 4);
 
-		if (_save->getTileEngine()->canTargetUnit(&origin, _aggroTarget->getTile(), &target, _unit, false))
+		if (canTarget[i])
 		{
 			_save->getPathfinding()->calculate(_unit, pos, BAM_NORMAL);
 			// can move here
@@ -2780,46 +2844,58 @@ bool AIModule::getNodeOfBestEfficacy(BattleAction *action, int radius)
 {
 	int bestScore = 2;
 	Position originVoxel = _save->getTileEngine()->getSightOriginVoxel(_unit);
-	Position targetVoxel;
-	for (std::vector<Node*>::const_iterator i = _save->getNodes()->begin(); i != _save->getNodes()->end(); ++i)
-	{
-		if ((*i)->isDummy())
-		{
-			continue;
-		}
-		int dist = Position::distance2d((*i)->getPosition(), _unit->getPosition());
-		if (dist <= 20 && dist > radius &&
-			_save->getTileEngine()->canTargetTile(&originVoxel, _save->getTile((*i)->getPosition()), O_FLOOR, &targetVoxel, _unit, false))
+	const std::vector<Node*> &nodes = *_save->getNodes();
+
+	// scoring only read map and units, all nodes can be scored at once, best is picked in order afterwards.
+	std::vector<int> scores(nodes.size(), INT_MIN);
+	ThreadPool::getShared().parallelFor(nodes.size(),
+		[&](size_t n, size_t)
 		{
-			int nodePoints = 0;
-			for (std::vector<BattleUnit*>::const_iterator j = _save->getUnits()->begin(); j != _save->getUnits()->end(); ++j)
+			const Node *node = nodes[n];
+			if (node->isDummy())
 			{
-				dist = Position::distance2d((*i)->getPosition(), (*j)->getPosition());
-				if (!(*j)->isOut() && dist < radius)
+				return;
+			}
+			Position targetVoxel;
+			int dist = Position::distance2d(node->getPosition(), _unit->getPosition());
+			if (dist <= 20 && dist > radius &&
+				_save->getTileEngine()->canTargetTile(&originVoxel, _save->getTile(node->getPosition()), O_FLOOR, &targetVoxel, _unit, false))
+			{
+				int nodePoints = 0;
+				for (std::vector<BattleUnit*>::const_iterator j = _save->getUnits()->begin(); j != _save->getUnits()->end(); ++j)
 				{
-					Position targetOriginVoxel = _save->getTileEngine()->getSightOriginVoxel(*j);
-					if (_save->getTileEngine()->canTargetTile(&targetOriginVoxel, _save->getTile((*i)->getPosition()), O_FLOOR, &targetVoxel, *j, false))
+					dist = Position::distance2d(node->getPosition(), (*j)->getPosition());
+					if (!(*j)->isOut() && dist < radius)
 					{
-						if ((_unit->getFaction() == FACTION_HOSTILE && (*j)->getFaction() != FACTION_HOSTILE) ||
-							(_unit->getFaction() == FACTION_NEUTRAL && (*j)->getFaction() == FACTION_HOSTILE))
+						Position targetOriginVoxel = _save->getTileEngine()->getSightOriginVoxel(*j);
+						if (_save->getTileEngine()->canTargetTile(&targetOriginVoxel, _save->getTile(node->getPosition()), O_FLOOR, &targetVoxel, *j, false))
 						{
-							if ((*j)->getTurnsSinceSpotted() <= _intelligence)
+							if ((_unit->getFaction() == FACTION_HOSTILE && (*j)->getFaction() != FACTION_HOSTILE) ||
+								(_unit->getFaction() == FACTION_NEUTRAL && (*j)->getFaction() == FACTION_HOSTILE))
 							{
-								nodePoints++;
+								if ((*j)->getTurnsSinceSpotted() <= _intelligence)
+								{
+									nodePoints++;
+								}
+							}
+							else
+							{
+								nodePoints -= 2;
 							}
-						}
-						else
-						{
-							nodePoints -= 2;
 						}
 					}
 				}
+				scores[n] = nodePoints;
 			}
-			if (nodePoints > bestScore)
-			{
-				bestScore = nodePoints;
-				action->target = (*i)->getPosition();
-			}
+		}
+	);
+
+	for (size_t n = 0; n < nodes.size(); ++n)
+	{
+		if (scores[n] > bestScore)
+		{
+			bestScore = scores[n];
+			action->target = nodes[n]->getPosition();
 		}
 	}
 	return bestScore > 2;
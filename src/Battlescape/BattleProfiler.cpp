@@ -0,0 +1,169 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BattleProfiler.h"
+#include <iomanip>
+#include <sstream>
+#include "../Engine/Logger.h"
+#include "../Engine/ThreadPool.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+const char *sectionNames[BPS_MAX] = { "pathfinding", "FOV", "reaction fire", "AI" };
+
+/// How deep is each section nested on main thread.
+int sectionDepth[BPS_MAX] = { };
+
+BattleProfiler::Clock::time_point turnStart = {};
+BattleProfiler::Clock::time_point battleStart = {};
+
+/// Stats of current side turn and whole battle.
+struct
+{
+	BattleProfiler::Clock::duration time[BPS_MAX];
+	size_t calls[BPS_MAX];
+} current = {}, battle = {};
+
+int battleTurns = 0;
+
+double toMs(BattleProfiler::Clock::duration d)
+{
+	return std::chrono::duration<double, std::milli>(d).count();
+}
+
+}
+
+/**
+ * Starts measuring section.
+ * @param section Section.
+ * @return False if section is already measured by outer scope or we are not on main thread.
+ */
+bool BattleProfiler::enter(BattleProfilerSection section)
+{
+	if (ThreadPool::getCurrentWorker() != 0)
+	{
+		return false;
+	}
+	return sectionDepth[section]++ == 0;
+}
+
+/**
+ * Stops measuring section and adds its time to current turn.
+ * @param section Section.
+ * @param time Time spent in section.
+ */
+void BattleProfiler::leave(BattleProfilerSection section, Clock::duration time)
+{
+	sectionDepth[section] = 0;
+	current.time[section] += time;
+	current.calls[section] += 1;
+}
+
+/**
+ * Writes stats to log.
+ * @param title First part of log line.
+ * @param report Stats.
+ */
+void BattleProfiler::log(const std::string &title, const Report &report)
+{
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(2);
+	ss << title << ": " << toMs(report.total) << "ms";
+	if (report.turns > 0 && report.turnsTime.count() > 0)
+	{
+		ss << ", " << report.turns / (toMs(report.turnsTime) / 1000.0) << " turns/s in " << report.turns << " turns";
+	}
+	for (int i = 0; i < BPS_MAX; ++i)
+	{
+		ss << ", " << sectionNames[i] << " " << toMs(report.sections[i].time) << "ms/" << report.sections[i].calls;
+	}
+	Log(LOG_INFO) << ss.str();
+}
+
+/**
+ * Resets all stats, called when battle starts or is loaded.
+ */
+void BattleProfiler::startBattle()
+{
+	current = {};
+	battle = {};
+	battleTurns = 0;
+	turnStart = Clock::now();
+	battleStart = turnStart;
+}
+
+/**
+ * Writes report of side turn that just ended and starts measuring next one.
+ * Time of turn include everything, animations and waiting for player input too.
+ * Rate of turns is over all turns played in battle so far.
+ * @param turn Turn number.
+ * @param side Faction that ended its turn.
+ */
+void BattleProfiler::endTurn(int turn, int side)
+{
+	if (!Options::oxceBattleProfiler)
+	{
+		return;
+	}
+
+	const auto now = Clock::now();
+	Report report;
+	report.total = now - turnStart;
+	for (int i = 0; i < BPS_MAX; ++i)
+	{
+		report.sections[i].time = current.time[i];
+		report.sections[i].calls = current.calls[i];
+		battle.time[i] += current.time[i];
+		battle.calls[i] += current.calls[i];
+	}
+	++battleTurns;
+	report.turns = battleTurns;
+	report.turnsTime = now - battleStart;
+	log("Battle profiler, turn " + std::to_string(turn) + " side " + std::to_string(side), report);
+
+	current = {};
+	turnStart = now;
+}
+
+/**
+ * Writes summary of whole battle.
+ */
+void BattleProfiler::endBattle()
+{
+	if (!Options::oxceBattleProfiler || battleTurns == 0)
+	{
+		return;
+	}
+
+	Report report;
+	report.total = turnStart - battleStart;
+	report.turns = battleTurns;
+	report.turnsTime = report.total;
+	for (int i = 0; i < BPS_MAX; ++i)
+	{
+		report.sections[i].time = battle.time[i];
+		report.sections[i].calls = battle.calls[i];
+	}
+	log("Battle profiler, whole battle", report);
+}
+
+}
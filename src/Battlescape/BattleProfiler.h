@@ -0,0 +1,101 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <string>
+#include "../Engine/Options.h"
+
+namespace OpenXcom
+{
+
+enum BattleProfilerSection { BPS_PATHFINDING, BPS_FOV, BPS_REACTION_FIRE, BPS_AI, BPS_MAX };
+
+/**
+ * Measures time spent in most expensive parts of battlescape logic.
+ * Enabled by `oxceBattleProfiler` option, report is written to log after each turn of each side
+ * and summary of whole battle when it ends.
+ * Only calls made from main thread are measured, nested calls of same section are counted once.
+ */
+class BattleProfiler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * Measures time from creation to destruction and adds it to given section.
+	 */
+	class Scope
+	{
+		BattleProfilerSection _section;
+		bool _active;
+		Clock::time_point _start;
+
+	public:
+		/// Starts measuring.
+		Scope(BattleProfilerSection section) : _section{ section }, _active{ Options::oxceBattleProfiler && enter(section) }
+		{
+			if (_active)
+			{
+				_start = Clock::now();
+			}
+		}
+		/// Stops measuring.
+		~Scope()
+		{
+			if (_active)
+			{
+				leave(_section, Clock::now() - _start);
+			}
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+private:
+	struct Stats
+	{
+		Clock::duration time = {};
+		size_t calls = 0;
+	};
+	struct Report
+	{
+		Stats sections[BPS_MAX];
+		Clock::duration total = {};
+		/// Side turns played in battle so far, and time they took.
+		int turns = 0;
+		Clock::duration turnsTime = {};
+	};
+
+	/// Starts measuring section, return false if it is already measured.
+	static bool enter(BattleProfilerSection section);
+	/// Stops measuring section.
+	static void leave(BattleProfilerSection section, Clock::duration time);
+	/// Writes report to log.
+	static void log(const std::string &title, const Report &report);
+
+public:
+	/// Resets all stats at start of battle.
+	static void startBattle();
+	/// Writes report of side turn that just ended.
+	static void endTurn(int turn, int side);
+	/// Writes summary of whole battle.
+	static void endBattle();
+};
+
+}
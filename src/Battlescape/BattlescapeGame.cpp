@@ -58,6 +58,7 @@
 #include "../Engine/Logger.h"
 #include "../Savegame/BattleUnitStatistics.h"
 #include "ConfirmEndMissionState.h"
+#include "BattleProfiler.h"
 #include "../fmath.h"
 
 namespace OpenXcom
@@ -185,6 +186,8 @@ BattlescapeGame::BattlescapeGame(SavedBattleGame *save, BattlescapeState *parent
 		_allEnemiesNeutralized = true; // just in case
 	}
 
+	BattleProfiler::startBattle();
+
 	_currentAction.actor = 0;
 	_currentAction.targeting = false;
 	_currentAction.type = BA_NONE;
@@ -202,6 +205,7 @@ BattlescapeGame::BattlescapeGame(SavedBattleGame *save, BattlescapeState *parent
  */
 BattlescapeGame::~BattlescapeGame()
 {
+	BattleProfiler::endBattle();
 	for (std::list<BattleState*>::iterator i = _states.begin(); i != _states.end(); ++i)
 	{
 		delete *i;
@@ -282,6 +286,7 @@ void BattlescapeGame::init()
  */
 void BattlescapeGame::handleAI(BattleUnit *unit)
 {
+	BattleProfiler::Scope profile(BPS_AI);
 	std::ostringstream ss;
 
 	if (unit->getTimeUnits() <= 5)
@@ -19,7 +19,6 @@
 #include <list>
 #include <algorithm>
 #include "Pathfinding.h"
-#include "PathfindingOpenSet.h"
 #include "../Savegame/SavedBattleGame.h"
 #include "../Savegame/Tile.h"
 #include "../Mod/Armor.h"
@@ -27,6 +26,7 @@
 #include "../Engine/Options.h"
 #include "../fmath.h"
 #include "BattlescapeGame.h"
+#include "BattleProfiler.h"
 
 namespace OpenXcom
 {
@@ -52,6 +52,9 @@ Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _unit(0), _pathPr
 	{
 		_nodes.push_back(PathfindingNode(_save->getTileCoords(i)));
 	}
+	// size * movement type * unit fly * missile target * missile
+	_transitions.resize(2 * (MT_SINK + 1) * 2 * 2 * 2);
+	_graphs.resize(_transitions.size());
 }
 
 /**
@@ -82,6 +85,7 @@ PathfindingNode *Pathfinding::getNode(Position pos)
  */
 void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleActionMove bam, const BattleUnit *missileTarget, int maxTUCost)
 {
+	BattleProfiler::Scope profile(BPS_PATHFINDING);
 	_totalTUCost = {};
 	_path.clear();
 	// i'm DONE with these out of bounds errors.
@@ -160,13 +164,84 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleAction
 	{
 		abortPath(); // if bresenham failed, we shouldn't keep the path it was attempting, in case A* fails too.
 	}
+	// for long AI paths on big maps, search cluster graph first and refine it locally.
+	if (Options::oxceHierarchicalPathfinding && missileTarget == 0 && bam != BAM_MISSILE && _unit->getFaction() != FACTION_PLAYER &&
+		Position::distance2d(startPosition, endPosition) > HIERARCHICAL_PATH_MIN_DISTANCE)
+	{
+		if (hierarchicalPath(startPosition, endPosition, bam, sneak, maxTUCost))
+		{
+			return;
+		}
+		abortPath();
+	}
 	// Now try through A*.
-	if (!aStarPath(startPosition, endPosition, bam, missileTarget, sneak, maxTUCost))
+	if (!aStarPath(startPosition, endPosition, bam, missileTarget, sneak, maxTUCost, Position(0, 0, 0), Position(_save->getMapSizeX() - 1, _save->getMapSizeY() - 1, _save->getMapSizeZ() - 1)))
 	{
 		abortPath();
 	}
 }
 
+/**
+ * Finds path over abstract graph of map clusters and then refines it
+ * with A* between each pair of its waypoints, each search is limited
+ * to clusters of its two waypoints.
+ * Path could be slightly longer than one from full A*.
+ * @param startPosition The position to start from.
+ * @param endPosition The position we want to reach.
+ * @param bam Move type.
+ * @param sneak Is the unit sneaking?
+ * @param maxTUCost Maximum time units the path can cost.
+ * @return True if a path exists, false otherwise.
+ */
+bool Pathfinding::hierarchicalPath(Position startPosition, Position endPosition, BattleActionMove bam, bool sneak, int maxTUCost)
+{
+	PathfindingGraph &graph = _graphs[getTransitionVariant(_unit, 0, bam)];
+	if (!graph.isInitialized())
+	{
+		graph.init(this, _save->getMapSizeX(), _save->getMapSizeY(), _save->getMapSizeZ());
+	}
+
+	std::vector<Position> waypoints;
+	if (!graph.findWaypoints(startPosition, endPosition, _unit, bam, waypoints))
+	{
+		return false;
+	}
+	waypoints.push_back(endPosition);
+
+	std::vector<int> path;
+	PathfindingCost totalCost = {};
+	Position segmentStart = startPosition;
+	for (Position segmentEnd : waypoints)
+	{
+		if (segmentStart == segmentEnd)
+		{
+			continue;
+		}
+		// waypoints are on borders of clusters, both ends of segment are in same or next cluster.
+		const int size = PathfindingGraph::ClusterSize;
+		Position windowMin(
+			std::max(std::min(segmentStart.x, segmentEnd.x) / size * size - 1, 0),
+			std::max(std::min(segmentStart.y, segmentEnd.y) / size * size - 1, 0),
+			0);
+		Position windowMax(
+			std::min((std::max(segmentStart.x, segmentEnd.x) / size + 1) * size, _save->getMapSizeX() - 1),
+			std::min((std::max(segmentStart.y, segmentEnd.y) / size + 1) * size, _save->getMapSizeY() - 1),
+			_save->getMapSizeZ() - 1);
+		if (!aStarPath(segmentStart, segmentEnd, bam, 0, sneak, maxTUCost - totalCost.time, windowMin, windowMax))
+		{
+			return false;
+		}
+		totalCost = totalCost + getNode(segmentEnd)->getTUCost(false);
+		// paths are stored in reverse order
+		path.insert(path.end(), _path.rbegin(), _path.rend());
+		segmentStart = segmentEnd;
+	}
+
+	_path.assign(path.rbegin(), path.rend());
+	_totalTUCost = totalCost;
+	return true;
+}
+
 /**
  * Calculates the shortest path using a simple A-Star algorithm.
  * The unit information and movement type must have already been set.
@@ -176,18 +251,34 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleAction
  * @param missileTarget Target of the path.
  * @param sneak Is the unit sneaking?
  * @param maxTUCost Maximum time units the path can cost.
+ * @param windowMin Lowest corner of box the path must stay in.
+ * @param windowMax Highest corner of box the path must stay in.
  * @return True if a path exists, false otherwise.
  */
-bool Pathfinding::aStarPath(Position startPosition, Position endPosition, BattleActionMove bam, const BattleUnit *missileTarget, bool sneak, int maxTUCost)
+bool Pathfinding::aStarPath(Position startPosition, Position endPosition, BattleActionMove bam, const BattleUnit *missileTarget, bool sneak, int maxTUCost, Position windowMin, Position windowMax)
 {
-	// reset every node, so we have to check them all
-	for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
-		it->reset();
+	auto inWindow = [&](Position pos)
+	{
+		return pos.x >= windowMin.x && pos.x <= windowMax.x && pos.y >= windowMin.y && pos.y <= windowMax.y && pos.z >= windowMin.z && pos.z <= windowMax.z;
+	};
+
+	// reset every node in window, nodes outside are never touched
+	for (int z = windowMin.z; z <= windowMax.z; ++z)
+	{
+		for (int y = windowMin.y; y <= windowMax.y; ++y)
+		{
+			for (int x = windowMin.x; x <= windowMax.x; ++x)
+			{
+				getNode(Position(x, y, z))->reset();
+			}
+		}
+	}
 
 	// start position is the first one in our "open" list
 	PathfindingNode *start = getNode(startPosition);
 	start->connect({}, 0, 0, endPosition);
-	PathfindingOpenSet openList;
+	PathfindingOpenSet &openList = _openSet;
+	openList.clear();
 	openList.push(start);
 	bool missile = (bam == BAM_MISSILE);
 	// if the open list is empty, we've reached the end
@@ -216,6 +307,8 @@ bool Pathfinding::aStarPath(Position startPosition, Position endPosition, Battle
 				continue;
 
 			Position nextPos = r.pos;
+			if (!inWindow(nextPos))
+				continue;
 			if (sneak && _save->getTile(nextPos)->getVisible()) r.cost.time *= 2; // avoid being seen
 			PathfindingNode *nextNode = getNode(nextPos);
 			if (nextNode->isChecked()) // Our algorithm means this node is already at minimum cost.
@@ -234,19 +327,127 @@ bool Pathfinding::aStarPath(Position startPosition, Position endPosition, Battle
 }
 
 /**
- * Gets the TU cost to move from 1 tile to the other (ONE STEP ONLY).
- * But also updates the endPosition, because it is possible
- * the unit goes upstairs or falls down while walking.
+ * Gets index of transition table for given kind of movement.
+ * @param unit The unit moving.
+ * @param missileTarget The target unit used for BAM_MISSILE.
+ * @param bam What move type is required.
+ * @return Index in `_transitions`.
+ */
+int Pathfinding::getTransitionVariant(const BattleUnit *unit, const BattleUnit *missileTarget, BattleActionMove bam) const
+{
+	int variant = unit->getArmor()->getSize() > 1 ? 1 : 0;
+	variant = variant * (MT_SINK + 1) + getMovementType(unit, missileTarget, bam);
+	variant = variant * 2 + (unit->getMovementType() == MT_FLY ? 1 : 0);
+	variant = variant * 2 + (missileTarget != 0 ? 1 : 0);
+	variant = variant * 2 + (bam == BAM_MISSILE ? 1 : 0);
+	return variant;
+}
+
+/**
+ * Gets terrain part of cost of one step, from cache if possible.
+ * @param startPosition The position to start from.
+ * @param direction The direction we are facing.
+ * @param unit The unit moving.
+ * @param missileTarget The target unit used for BAM_MISSILE.
+ * @param bam What move type is required.
+ * @return Transition, valid until next call.
+ */
+const PathfindingTransition &Pathfinding::getTransition(Position startPosition, int direction, const BattleUnit *unit, const BattleUnit *missileTarget, BattleActionMove bam) const
+{
+	static const PathfindingTransition invalidTransition = { true, false };
+
+	if (!_save->getTile(startPosition))
+	{
+		return invalidTransition;
+	}
+
+	std::vector<PathfindingTransition> &table = _transitions[getTransitionVariant(unit, missileTarget, bam)];
+	if (table.empty())
+	{
+		table.resize((size_t)_size * dir_max);
+	}
+
+	PathfindingTransition &transition = table[(size_t)_save->getTileIndex(startPosition) * dir_max + direction];
+	if (!transition.known)
+	{
+		calculateTransition(transition, startPosition, direction, unit, missileTarget, bam);
+		transition.known = true;
+	}
+	return transition;
+}
+
+/**
+ * Removes cached move costs that could depend on given tile.
+ * Need be called every time terrain of tile change.
+ * @param pos Position of changed tile.
+ */
+void Pathfinding::invalidateTransitions(Position pos)
+{
+	// how far `calculateTransition` can look from start tile.
+	const int rangeXY = 3;
+	const int rangeZ = 2;
+
+	if (_save->getMapSizeXYZ() != _size)
+	{
+		// map is rebuilt, nothing here is valid.
+		clearTransitions();
+		_graphs.assign(_graphs.size(), PathfindingGraph());
+		return;
+	}
+
+	for (auto& graph : _graphs)
+	{
+		graph.invalidate(pos);
+	}
+
+	for (auto& table : _transitions)
+	{
+		if (table.empty())
+		{
+			continue;
+		}
+		for (int z = std::max(pos.z - rangeZ, 0); z <= std::min(pos.z + rangeZ, _save->getMapSizeZ() - 1); ++z)
+		{
+			for (int y = std::max(pos.y - rangeXY, 0); y <= std::min(pos.y + rangeXY, _save->getMapSizeY() - 1); ++y)
+			{
+				for (int x = std::max(pos.x - rangeXY, 0); x <= std::min(pos.x + rangeXY, _save->getMapSizeX() - 1); ++x)
+				{
+					PathfindingTransition *transition = &table[(size_t)_save->getTileIndex(Position(x, y, z)) * dir_max];
+					for (int d = 0; d < dir_max; ++d)
+					{
+						transition[d].known = false;
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Removes all cached move costs.
+ */
+void Pathfinding::clearTransitions()
+{
+	for (auto& table : _transitions)
+	{
+		table.clear();
+	}
+}
+
+/**
+ * Calculates part of cost of one step that depend only on terrain.
+ * Units, fire and smoke are checked by `getTUCost` as they change all the time.
+ * @param result Transition to fill.
  * @param startPosition The position to start from.
  * @param direction The direction we are facing.
- * @param endPosition The position we want to reach.
  * @param unit The unit moving.
  * @param missileTarget The target unit used for BAM_MISSILE.
  * @param bam What move type is required (one special case is BAM_MISSILE)?
- * @return TU cost or 255 if movement is impossible.
  */
-PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, const BattleUnit *unit, const BattleUnit *missileTarget, BattleActionMove bam) const
+void Pathfinding::calculateTransition(PathfindingTransition &result, Position startPosition, int direction, const BattleUnit *unit, const BattleUnit *missileTarget, BattleActionMove bam) const
 {
+	result = { };
+
 	Position pos;
 	directionToVector(direction, &pos);
 	pos += startPosition;
@@ -282,7 +483,7 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 		Tile* dt = _save->getTile(pos + offsets[i]);
 		if (!st || !dt)
 		{
-			return {{INVALID_MOVE_COST, 0}};
+			return;
 		}
 		startTile[i] = st;
 		destinationTile[i] = dt;
@@ -298,9 +499,9 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 		{
 			// check if we can go this way
 			if (isBlockedDirection(unit, startTile[i], direction, bam, missileTarget))
-				return {{INVALID_MOVE_COST, 0}};
+				return;
 			if (startTile[i]->getTerrainLevel() - destinationTile[i]->getTerrainLevel() > 8)
-				return {{INVALID_MOVE_COST, 0}};
+				return;
 		}
 
 		// if we are on a stairs try to go up a level
@@ -314,12 +515,8 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 		}
 		else if (bam != BAM_MISSILE && movementType == MT_FLY)
 		{
-			// 2 or more voxels poking into this tile = no go
-			BattleUnit* overlaping = destinationTile[i]->getOverlappingUnit(_save, TUO_IGNORE_SMALL);
-			if (overlaping && overlaping != unit)
-			{
-				return {{INVALID_MOVE_COST, 0}};
-			}
+			// 2 or more voxels poking into this tile = no go, units are checked in `getTUCost`
+			result.maskCheckOverlap |= maskCurrentPart;
 		}
 
 		Tile* aboveStart =_save->getAboveTile(startTile[i]);
@@ -351,7 +548,7 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 	{
 		if (direction != DIR_DOWN)
 		{
-			return {{INVALID_MOVE_COST, 0}}; //cannot walk on air
+			return; //cannot walk on air
 		}
 	}
 
@@ -366,10 +563,14 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 			destinationTile[i] = belowDestination[i];
 		}
 
-		// check if the destination tile can be walked over
-		if (isBlocked(unit, destinationTile[i], O_FLOOR, bam, missileTarget) || isBlocked(unit, destinationTile[i], O_OBJECT, bam, missileTarget))
+		// check if the destination tile can be walked over, units are checked in `getTUCost`
+		if (destinationTile[i] == 0 || isBlocked(unit, destinationTile[i], O_OBJECT, bam, missileTarget))
 		{
-			return {{INVALID_MOVE_COST, 0}};
+			return;
+		}
+		if (isBlockedPart(destinationTile[i], O_FLOOR, missileTarget, movementType))
+		{
+			result.maskFloorBlocked |= 1 << i;
 		}
 	}
 
@@ -380,28 +581,11 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 		if ((t->isDoor(O_NORTHWALL)) ||
 			(t->isDoor(O_WESTWALL)))
 		{
-			return {{INVALID_MOVE_COST, 0}};
+			return;
 		}
 	}
 
-	// pre-calculate fire penalty (to make it consistent for 2x2 units)
-	int firePenaltyCost = 0;
-	if (unit->getFaction() != FACTION_PLAYER &&
-		unit->getSpecialAbility() < SPECAB_BURNFLOOR)
-	{
-		for (int i = 0; i < numberOfParts; ++i)
-		{
-			if (destinationTile[i]->getFire() > 0)
-			{
-				firePenaltyCost = FIRE_PREVIEW_MOVE_COST; // try to find a better path, but don't exclude this path entirely.
-			}
-		}
-	}
-
-
 	// calculate cost and some final checks
-	int totalCost = 0;
-
 	for (int i = 0; i < numberOfParts; ++i)
 	{
 		int cost = 0;
@@ -411,9 +595,9 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 		{
 			// check if we can go this way
 			if (isBlockedDirection(unit, startTile[i], direction, bam, missileTarget))
-				return {{INVALID_MOVE_COST, 0}};
+				return;
 			if (startTile[i]->getTerrainLevel() - destinationTile[i]->getTerrainLevel() > 8)
-				return {{INVALID_MOVE_COST, 0}};
+				return;
 		}
 		else if (direction >= DIR_UP && !triedStairsDown)
 		{
@@ -424,7 +608,7 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 			}
 			else
 			{
-				return {{INVALID_MOVE_COST, 0}};
+				return;
 			}
 		}
 		if (upperLevel)
@@ -435,9 +619,9 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 			{
 				// check if we can go this way
 				if (isBlockedDirection(unit, startTile[i], direction, bam, missileTarget))
-					return {{INVALID_MOVE_COST, 0}};
+					return;
 				if (startTile[i]->getTerrainLevel() - destinationTile[i]->getTerrainLevel() > 8)
-					return {{INVALID_MOVE_COST, 0}};
+					return;
 			}
 		}
 
@@ -456,7 +640,7 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 		// for backward compatiblity (100 + 100 + 100 > 255) or for (255 + 10 > 255)
 		if (wallcost >= INVALID_MOVE_COST)
 		{
-			return {{INVALID_MOVE_COST, 0}};
+			return;
 		}
 
 		// if we don't want to fall down and there is no floor, we can't know the TUs so it's default to 4
@@ -494,69 +678,174 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 
 		cost += wallcost;
 
-		// TFTD thing: underwater tiles on fire or filled with smoke cost 2 TUs more for whatever reason.
-		if (_save->getDepth() > 0 && (destinationTile[i]->getFire() > 0 || destinationTile[i]->getSmoke() > 0))
-		{
-			cost += 2;
-		}
-
-		// Strafing costs +1 for forwards-ish or sidewards, propose +2 for backwards-ish directions
-		// Maybe if flying then it makes no difference?
-		if (_strafeMove && bam == BAM_STRAFE)
-		{
-			if (unit->getDirection() != direction)
-			{
-				cost += 1;
-			}
-		}
-
-		// cap move cost to given limit
-		cost = std::min(cost, +MAX_MOVE_COST);
-
-		totalCost += cost;
+		// cap move cost to given limit, `getTUCost` add only positive values, so capping it again give same result.
+		result.partCost[i] = (Uint8)std::min(cost, +MAX_MOVE_COST);
 	}
 
 	// because unit move up or down we adjust final position
 	if (triedStairs)
 	{
 		pos.z++;
+		result.levelChange = 1;
 	}
 	else if (direction != DIR_DOWN && triedStairsDown)
 	{
 		pos.z--;
+		result.levelChange = -1;
 	}
 
 	// for bigger sized units, check the path between parts in an X shape at the end position
 	if (size)
 	{
-		totalCost /= numberOfParts;
 		Tile *originTile = _save->getTile(pos + Position(1,1,0));
 		Tile *finalTile = _save->getTile(pos);
 		int tmpDirection = 7;
 		if (isBlockedDirection(unit, originTile, tmpDirection, bam, missileTarget))
-			return {{INVALID_MOVE_COST, 0}};
+			return;
 		if (!triedStairsDown && abs(originTile->getTerrainLevel() - finalTile->getTerrainLevel()) > 10)
-			return {{INVALID_MOVE_COST, 0}};
+			return;
 		originTile = _save->getTile(pos + Position(1,0,0));
 		finalTile = _save->getTile(pos + Position(0,1,0));
 		tmpDirection = 5;
 		if (isBlockedDirection(unit, originTile, tmpDirection, bam, missileTarget))
-			return {{INVALID_MOVE_COST, 0}};
+			return;
 		if (!triedStairsDown && abs(originTile->getTerrainLevel() - finalTile->getTerrainLevel()) > 10)
+			return;
+	}
+
+	result.valid = true;
+	result.fallingDown = fallingDown;
+	result.flying = flying;
+}
+
+/**
+ * Gets the TU cost to move from 1 tile to the other (ONE STEP ONLY).
+ * But also updates the endPosition, because it is possible
+ * the unit goes upstairs or falls down while walking.
+ * Terrain part of calculation is cached, see `calculateTransition`.
+ * @param startPosition The position to start from.
+ * @param direction The direction we are facing.
+ * @param endPosition The position we want to reach.
+ * @param unit The unit moving.
+ * @param missileTarget The target unit used for BAM_MISSILE.
+ * @param bam What move type is required (one special case is BAM_MISSILE)?
+ * @return TU cost or 255 if movement is impossible.
+ */
+PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, const BattleUnit *unit, const BattleUnit *missileTarget, BattleActionMove bam) const
+{
+	const PathfindingTransition &transition = getTransition(startPosition, direction, unit, missileTarget, bam);
+	if (!transition.valid)
+	{
+		return {{INVALID_MOVE_COST, 0}};
+	}
+
+	Position pos;
+	directionToVector(direction, &pos);
+	pos += startPosition;
+
+	const MovementType movementType = getMovementType(unit, missileTarget, bam);
+	const Armor* armor =  unit->getArmor();
+	const int size = armor->getSize() - 1;
+	const int numberOfParts = armor->getTotalSize();
+
+	Position offsets[4] =
+	{
+		{ 0, 0, 0 },
+		{ 1, 0, 0 },
+		{ 0, 1, 0 },
+		{ 1, 1, 0 },
+	};
+	Tile* destinationTile[4] = { };
+
+	for (int i = 0; i < numberOfParts; ++i)
+	{
+		if (transition.maskCheckOverlap & (1 << i))
+		{
+			// 2 or more voxels poking into this tile = no go
+			BattleUnit* overlaping = _save->getTile(pos + offsets[i])->getOverlappingUnit(_save, TUO_IGNORE_SMALL);
+			if (overlaping && overlaping != unit)
+			{
+				return {{INVALID_MOVE_COST, 0}};
+			}
+		}
+	}
+
+	// because unit move up or down we adjust final position
+	pos.z += transition.levelChange;
+
+	for (int i = 0; i < numberOfParts; ++i)
+	{
+		destinationTile[i] = _save->getTile(pos + offsets[i]);
+
+		// check if the destination tile can be walked over
+		FloorUnitCheck floorCheck = checkUnitOnFloor(unit, destinationTile[i], missileTarget, movementType);
+		if (floorCheck == FLOOR_UNIT_BLOCK || (floorCheck == FLOOR_UNIT_NONE && (transition.maskFloorBlocked & (1 << i))))
+		{
 			return {{INVALID_MOVE_COST, 0}};
+		}
 	}
 
+	// pre-calculate fire penalty (to make it consistent for 2x2 units)
+	int firePenaltyCost = 0;
+	if (unit->getFaction() != FACTION_PLAYER &&
+		unit->getSpecialAbility() < SPECAB_BURNFLOOR)
+	{
+		for (int i = 0; i < numberOfParts; ++i)
+		{
+			if (destinationTile[i]->getFire() > 0)
+			{
+				firePenaltyCost = FIRE_PREVIEW_MOVE_COST; // try to find a better path, but don't exclude this path entirely.
+			}
+		}
+	}
 
 	if (bam == BAM_MISSILE)
 	{
 		return { { }, { }, pos };
 	}
 
-	if (direction == DIR_DOWN && fallingDown)
+	if (direction == DIR_DOWN && transition.fallingDown)
 	{
 		return { { }, { firePenaltyCost, 0 }, pos };
 	}
 
+	// calculate cost
+	int totalCost = 0;
+
+	for (int i = 0; i < numberOfParts; ++i)
+	{
+		int cost = transition.partCost[i];
+
+		// TFTD thing: underwater tiles on fire or filled with smoke cost 2 TUs more for whatever reason.
+		if (_save->getDepth() > 0 && (destinationTile[i]->getFire() > 0 || destinationTile[i]->getSmoke() > 0))
+		{
+			cost += 2;
+		}
+
+		// Strafing costs +1 for forwards-ish or sidewards, propose +2 for backwards-ish directions
+		// Maybe if flying then it makes no difference?
+		if (_strafeMove && bam == BAM_STRAFE)
+		{
+			if (unit->getDirection() != direction)
+			{
+				cost += 1;
+			}
+		}
+
+		// cap move cost to given limit
+		cost = std::min(cost, +MAX_MOVE_COST);
+
+		totalCost += cost;
+	}
+
+	// for bigger sized units, cost is average of all parts
+	if (size)
+	{
+		totalCost /= numberOfParts;
+	}
+
+	const bool flying = transition.flying;
+
 	const int costDiv = 100 * 100 * 100;
 	ArmorMoveCost cost = { totalCost, totalCost };
 
@@ -746,59 +1035,88 @@ bool Pathfinding::isBlocked(const BattleUnit *unit, const Tile *tile, const int
 	}
 	if (part == O_FLOOR)
 	{
-		if (tile->getUnit())
+		FloorUnitCheck floorCheck = checkUnitOnFloor(unit, tile, missileTarget, movementType);
+		if (floorCheck == FLOOR_UNIT_IGNORE) return false;
+		if (floorCheck == FLOOR_UNIT_BLOCK) return true;
+	}
+	return isBlockedPart(tile, part, missileTarget, movementType);
+}
+
+/**
+ * Checks how units on or below a tile affect moving onto its floor.
+ * @param unit Unit that move.
+ * @param tile Specified tile.
+ * @param missileTarget Target for a missile.
+ * @param movementType Movement type used.
+ * @return If unit block floor, or it should be ignored, or only terrain need be checked.
+ */
+Pathfinding::FloorUnitCheck Pathfinding::checkUnitOnFloor(const BattleUnit *unit, const Tile *tile, const BattleUnit *missileTarget, MovementType movementType) const
+{
+	if (tile->getUnit())
+	{
+		BattleUnit *u = tile->getUnit();
+		if (u == unit || u == missileTarget || u->isOut()) return FLOOR_UNIT_IGNORE;
+		if (missileTarget && u != missileTarget && u->getFaction() == FACTION_HOSTILE)
+			return FLOOR_UNIT_BLOCK;			// AI pathfinding with missiles shouldn't path through their own units
+		if (unit)
 		{
-			BattleUnit *u = tile->getUnit();
-			if (u == unit || u == missileTarget || u->isOut()) return false;
-			if (missileTarget && u != missileTarget && u->getFaction() == FACTION_HOSTILE)
-				return true;			// AI pathfinding with missiles shouldn't path through their own units
-			if (unit)
-			{
-				if (unit->getFaction() == FACTION_PLAYER && u->getVisible()) return true;		// player know all visible units
-				if (unit->getFaction() == u->getFaction()) return true;
-				if (unit->getFaction() == FACTION_HOSTILE &&
-					std::find(unit->getUnitsSpottedThisTurn().begin(), unit->getUnitsSpottedThisTurn().end(), u) != unit->getUnitsSpottedThisTurn().end()) return true;
-			}
+			if (unit->getFaction() == FACTION_PLAYER && u->getVisible()) return FLOOR_UNIT_BLOCK;		// player know all visible units
+			if (unit->getFaction() == u->getFaction()) return FLOOR_UNIT_BLOCK;
+			if (unit->getFaction() == FACTION_HOSTILE &&
+				std::find(unit->getUnitsSpottedThisTurn().begin(), unit->getUnitsSpottedThisTurn().end(), u) != unit->getUnitsSpottedThisTurn().end()) return FLOOR_UNIT_BLOCK;
 		}
-		else if (tile->hasNoFloor(0) && movementType != MT_FLY) // this whole section is devoted to making large units not take part in any kind of falling behaviour
+	}
+	else if (tile->hasNoFloor(0) && movementType != MT_FLY) // this whole section is devoted to making large units not take part in any kind of falling behaviour
+	{
+		Position pos = tile->getPosition();
+		while (pos.z >= 0)
 		{
-			Position pos = tile->getPosition();
-			while (pos.z >= 0)
-			{
-				Tile *t = _save->getTile(pos);
-				BattleUnit *u = t->getUnit();
+			Tile *t = _save->getTile(pos);
+			BattleUnit *u = t->getUnit();
 
-				if (u != 0 && u != unit)
+			if (u != 0 && u != unit)
+			{
+				// don't let large units fall on other units
+				if (unit && unit->isBigUnit())
 				{
-					// don't let large units fall on other units
-					if (unit && unit->isBigUnit())
-					{
-						return true;
-					}
-					// don't let any units fall on large units
-					if (u != unit && u != missileTarget && !u->isOut() && u->isBigUnit())
-					{
-						return true;
-					}
+					return FLOOR_UNIT_BLOCK;
 				}
-				// not gonna fall any further, so we can stop checking.
-				if (!t->hasNoFloor(0))
+				// don't let any units fall on large units
+				if (u != unit && u != missileTarget && !u->isOut() && u->isBigUnit())
 				{
-					break;
+					return FLOOR_UNIT_BLOCK;
 				}
-				pos.z--;
 			}
+			// not gonna fall any further, so we can stop checking.
+			if (!t->hasNoFloor(0))
+			{
+				break;
+			}
+			pos.z--;
 		}
 	}
+	return FLOOR_UNIT_NONE;
+}
+
+/**
+ * Determines whether terrain of a certain part of a tile blocks movement.
+ * @param tile Specified tile.
+ * @param part Part of the tile.
+ * @param missileTarget Target for a missile.
+ * @param movementType Movement type used.
+ * @return True if the movement is blocked.
+ */
+bool Pathfinding::isBlockedPart(const Tile *tile, const int part, const BattleUnit *missileTarget, MovementType movementType) const
+{
 	// missiles can't pathfind through closed doors.
-	{ TilePart tp = (TilePart)part;
+	TilePart tp = (TilePart)part;
 	if (missileTarget != 0 && tile->getMapData(tp) &&
 		(tile->isDoor(tp) ||
 		(tile->isUfoDoor(tp) &&
 		!tile->isUfoDoorOpen(tp))))
 	{
 		return true;
-	}}
+	}
 	if (tile->getTUCost(part, movementType) == Pathfinding::INVALID_MOVE_COST) return true; // blocking part
 	return false;
 }
@@ -1321,6 +1639,7 @@ bool Pathfinding::bresenhamPath(Position origin, Position target, BattleActionMo
  */
 std::vector<int> Pathfinding::findReachable(const BattleUnit *unit, const BattleActionCost &cost)
 {
+	BattleProfiler::Scope profile(BPS_PATHFINDING);
 	const Position start = unit->getPosition();
 	int tuMax = unit->getTimeUnits() - cost.Time;
 	int energyMax = unit->getEnergy() - cost.Energy;
@@ -1333,7 +1652,8 @@ std::vector<int> Pathfinding::findReachable(const BattleUnit *unit, const Battle
 	}
 	PathfindingNode *startNode = getNode(start);
 	startNode->connect({}, 0, 0);
-	PathfindingOpenSet unvisited;
+	PathfindingOpenSet &unvisited = _openSet;
+	unvisited.clear();
 	unvisited.push(startNode);
 	std::vector<PathfindingNode*> reachable;
 	while (!unvisited.empty())
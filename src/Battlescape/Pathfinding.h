@@ -20,6 +20,8 @@
 #include <vector>
 #include "Position.h"
 #include "PathfindingNode.h"
+#include "PathfindingOpenSet.h"
+#include "PathfindingGraph.h"
 #include "../Mod/MapData.h"
 
 namespace OpenXcom
@@ -32,6 +34,28 @@ struct BattleActionCost;
 
 enum BattleActionMove : char;
 
+/**
+ * Part of one pathfinding step that depend only on terrain, cached for each tile and direction.
+ */
+struct PathfindingTransition
+{
+	/// Was this transition already calculated.
+	bool known = false;
+	/// Can terrain be crossed in this direction.
+	bool valid = false;
+	/// Unit have nothing to stand on.
+	bool fallingDown = false;
+	/// Unit is flying over empty space.
+	bool flying = false;
+	/// Level change after using stairs or walking down.
+	Sint8 levelChange = 0;
+	/// Parts where floor of final tile is blocked by terrain.
+	Uint8 maskFloorBlocked = 0;
+	/// Parts where final tile need be checked for overlapping units.
+	Uint8 maskCheckOverlap = 0;
+	/// Cost of each part without fire, smoke and strafe.
+	Uint8 partCost[4] = { };
+};
 
 /**
  * A utility class that calculates the shortest path between two points on the battlescape map.
@@ -46,6 +70,7 @@ private:
 
 	SavedBattleGame *_save;
 	std::vector<PathfindingNode> _nodes;
+	PathfindingOpenSet _openSet;
 	int _size;
 	BattleUnit *_unit;
 	bool _pathPreviewed;
@@ -53,6 +78,14 @@ private:
 	bool _ctrlUsed = false;
 	bool _altUsed = false;
 	PathfindingCost _totalTUCost;
+	/// Cached terrain part of move costs, one table for each kind of movement, see `getTransitionVariant`.
+	mutable std::vector<std::vector<PathfindingTransition>> _transitions;
+	/// Graphs of map clusters for long paths, one for each kind of movement like `_transitions`.
+	std::vector<PathfindingGraph> _graphs;
+	friend class PathfindingGraph;
+
+	/// How units on tile affect moving onto its floor.
+	enum FloorUnitCheck { FLOOR_UNIT_NONE, FLOOR_UNIT_IGNORE, FLOOR_UNIT_BLOCK };
 
 	/// Gets the node at certain position.
 	PathfindingNode *getNode(Position pos);
@@ -61,12 +94,24 @@ private:
 	MovementType getMovementType(const BattleUnit *unit, const BattleUnit *missileTarget, BattleActionMove bam) const;
 	/// Determines whether a tile blocks a certain movementType.
 	bool isBlocked(const BattleUnit *unit, const Tile *tile, const int part, BattleActionMove bam, const BattleUnit *missileTarget, int bigWallExclusion = -1) const;
+	/// Checks how units on tile affect moving onto its floor.
+	FloorUnitCheck checkUnitOnFloor(const BattleUnit *unit, const Tile *tile, const BattleUnit *missileTarget, MovementType movementType) const;
+	/// Determines whether terrain of a tile part blocks movement.
+	bool isBlockedPart(const Tile *tile, const int part, const BattleUnit *missileTarget, MovementType movementType) const;
 	/// Determines whether or not movement between start tile and end tile is possible in the direction.
 	bool isBlockedDirection(const BattleUnit *unit, Tile *startTile, const int direction, BattleActionMove bam, const BattleUnit *missileTarget) const;
+	/// Gets index of transition table for given kind of movement.
+	int getTransitionVariant(const BattleUnit *unit, const BattleUnit *missileTarget, BattleActionMove bam) const;
+	/// Gets terrain part of move cost from cache.
+	const PathfindingTransition &getTransition(Position startPosition, int direction, const BattleUnit *unit, const BattleUnit *missileTarget, BattleActionMove bam) const;
+	/// Calculates terrain part of move cost.
+	void calculateTransition(PathfindingTransition &result, Position startPosition, int direction, const BattleUnit *unit, const BattleUnit *missileTarget, BattleActionMove bam) const;
 	/// Tries to find a straight line path between two positions.
 	bool bresenhamPath(Position origin, Position target, BattleActionMove bam, const BattleUnit *missileTarget, bool sneak = false, int maxTUCost = 1000);
-	/// Tries to find a path between two positions.
-	bool aStarPath(Position origin, Position target, BattleActionMove bam, const BattleUnit *missileTarget, bool sneak = false, int maxTUCost = 1000);
+	/// Tries to find a path between two positions, inside a box of the map.
+	bool aStarPath(Position origin, Position target, BattleActionMove bam, const BattleUnit *missileTarget, bool sneak, int maxTUCost, Position windowMin, Position windowMax);
+	/// Tries to find a long path between two positions using cluster graph.
+	bool hierarchicalPath(Position origin, Position target, BattleActionMove bam, bool sneak, int maxTUCost);
 	/// Determines whether a unit can fall down from this tile.
 	bool canFallDown(Tile *destinationTile) const;
 	/// Determines whether a unit can fall down from this tile.
@@ -86,6 +131,8 @@ public:
 	static constexpr int INVALID_MOVE_COST = 255;
 	/// Fire penalty used in path search.
 	static constexpr int FIRE_PREVIEW_MOVE_COST = 32;
+	/// Minimal distance of path to use cluster graph.
+	static constexpr int HIERARCHICAL_PATH_MIN_DISTANCE = 3 * PathfindingGraph::ClusterSize;
 
 	static const int DIR_UP = 8;
 	static const int DIR_DOWN = 9;
@@ -147,6 +194,10 @@ public:
 	int dequeuePath();
 	/// Gets the TU cost to move from 1 tile to the other.
 	PathfindingStep getTUCost(Position startPosition, int direction, const BattleUnit *unit, const BattleUnit *missileTarget, BattleActionMove bam) const;
+	/// Removes cached move costs affected by change of terrain at given position.
+	void invalidateTransitions(Position pos);
+	/// Removes all cached move costs.
+	void clearTransitions();
 	/// Aborts the current path.
 	void abortPath();
 	/// Gets the strafe move setting.
@@ -0,0 +1,492 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <climits>
+#include <queue>
+#include <unordered_map>
+#include "PathfindingGraph.h"
+#include "Pathfinding.h"
+#include "../Savegame/SavedBattleGame.h"
+#include "../Savegame/BattleUnit.h"
+#include "../Mod/Armor.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+/// Cost used for tiles that can't be reached.
+constexpr int UnreachableCost = INT_MAX;
+
+/// Entry of priority queue, cost and tile.
+using QueueEntry = std::pair<int, int>;
+using Queue = std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>>;
+
+}
+
+/**
+ * Creates empty graph.
+ */
+PathfindingGraph::PathfindingGraph() : _pathfinding(nullptr), _mapX(0), _mapY(0), _mapZ(0), _clustersX(0), _clustersY(0)
+{
+
+}
+
+/**
+ * Cleans up the graph.
+ */
+PathfindingGraph::~PathfindingGraph()
+{
+
+}
+
+/**
+ * Sets up empty clusters for given map, all of them will be built on first use.
+ * @param pathfinding Pathfinding used to get terrain move costs.
+ * @param mapX Map width.
+ * @param mapY Map length.
+ * @param mapZ Map height.
+ */
+void PathfindingGraph::init(Pathfinding *pathfinding, int mapX, int mapY, int mapZ)
+{
+	_pathfinding = pathfinding;
+	_mapX = mapX;
+	_mapY = mapY;
+	_mapZ = mapZ;
+	_clustersX = (mapX + ClusterSize - 1) / ClusterSize;
+	_clustersY = (mapY + ClusterSize - 1) / ClusterSize;
+	_clusters.clear();
+	_clusters.resize(_clustersX * _clustersY);
+	_bordersEast.clear();
+	_bordersEast.resize(_clustersX * _clustersY);
+	_bordersSouth.clear();
+	_bordersSouth.resize(_clustersX * _clustersY);
+}
+
+/**
+ * Converts tile index to position.
+ * @param tile Tile index.
+ * @return Tile position.
+ */
+Position PathfindingGraph::getTilePosition(int tile) const
+{
+	return Position(tile % _mapX, (tile / _mapX) % _mapY, tile / (_mapX * _mapY));
+}
+
+/**
+ * Gets cost of one step, using only terrain part of pathfinding.
+ * @param pos Start position.
+ * @param direction Direction of move.
+ * @param unit Unit that move.
+ * @param bam Move type.
+ * @param next Final position of move.
+ * @return Cost of move or `UnreachableCost`.
+ */
+int PathfindingGraph::getStepCost(Position pos, int direction, const BattleUnit *unit, BattleActionMove bam, Position &next) const
+{
+	const PathfindingTransition &transition = _pathfinding->getTransition(pos, direction, unit, nullptr, bam);
+	if (!transition.valid || transition.maskFloorBlocked)
+	{
+		return UnreachableCost;
+	}
+
+	const int numberOfParts = unit->getArmor()->getTotalSize();
+	int cost = 0;
+	for (int i = 0; i < numberOfParts; ++i)
+	{
+		cost += transition.partCost[i];
+	}
+
+	Pathfinding::directionToVector(direction, &next);
+	next += pos;
+	next.z += transition.levelChange;
+	return std::max(cost / numberOfParts, 1);
+}
+
+/**
+ * Calculates costs of reaching every tile of a cluster from given tile, without leaving the cluster.
+ * @param cluster Cluster index.
+ * @param start Start position, need be inside cluster.
+ * @param unit Unit that move.
+ * @param bam Move type.
+ * @param costs Costs for each tile of cluster, indexed by local index.
+ */
+void PathfindingGraph::searchCluster(int cluster, Position start, const BattleUnit *unit, BattleActionMove bam, std::vector<int> &costs) const
+{
+	const int x0 = (cluster % _clustersX) * ClusterSize;
+	const int y0 = (cluster / _clustersX) * ClusterSize;
+	const int w = std::min(ClusterSize, _mapX - x0);
+	const int h = std::min(ClusterSize, _mapY - y0);
+	auto localIndex = [&](Position p) { return (p.z * h + (p.y - y0)) * w + (p.x - x0); };
+
+	costs.assign(w * h * _mapZ, UnreachableCost);
+
+	Queue queue;
+	costs[localIndex(start)] = 0;
+	queue.push({ 0, localIndex(start) });
+	while (!queue.empty())
+	{
+		const QueueEntry top = queue.top();
+		queue.pop();
+		if (top.first != costs[top.second])
+		{
+			continue;
+		}
+		const Position pos = Position(x0 + top.second % w, y0 + (top.second / w) % h, top.second / (w * h));
+		for (int direction = 0; direction < 10; ++direction)
+		{
+			Position next;
+			const int step = getStepCost(pos, direction, unit, bam, next);
+			if (step == UnreachableCost || next.x < x0 || next.x >= x0 + w || next.y < y0 || next.y >= y0 + h)
+			{
+				continue;
+			}
+			const int nextIndex = localIndex(next);
+			if (top.first + step < costs[nextIndex])
+			{
+				costs[nextIndex] = top.first + step;
+				queue.push({ costs[nextIndex], nextIndex });
+			}
+		}
+	}
+}
+
+/**
+ * Recalculates places where units can cross the border of a cluster.
+ * Each run of neighbouring tiles where crossing is possible give one crossing in its middle.
+ * @param cluster Cluster on west or north side of border.
+ * @param east Border to east neighbour, otherwise to south neighbour.
+ * @param unit Unit that move.
+ * @param bam Move type.
+ */
+void PathfindingGraph::updateBorder(int cluster, bool east, const BattleUnit *unit, BattleActionMove bam)
+{
+	Border &border = east ? _bordersEast[cluster] : _bordersSouth[cluster];
+	if (!border.dirty)
+	{
+		return;
+	}
+	border.dirty = false;
+	border.crossings.clear();
+
+	const int cx = cluster % _clustersX;
+	const int cy = cluster / _clustersX;
+	if ((east && cx + 1 >= _clustersX) || (!east && cy + 1 >= _clustersY))
+	{
+		return;
+	}
+	const int neighbour = east ? cluster + 1 : cluster + _clustersX;
+
+	// nodes of both clusters change
+	_clusters[cluster].dirty = true;
+	_clusters[neighbour].dirty = true;
+
+	const int x0 = cx * ClusterSize;
+	const int y0 = cy * ClusterSize;
+	const int length = east ? std::min(ClusterSize, _mapY - y0) : std::min(ClusterSize, _mapX - x0);
+	// tile on this side of border, for i-th tile along it.
+	auto borderTile = [&](int i, int z)
+	{
+		return east ? Position(x0 + ClusterSize - 1, y0 + i, z) : Position(x0 + i, y0 + ClusterSize - 1, z);
+	};
+	const Position across = east ? Position(1, 0, 0) : Position(0, 1, 0);
+
+	for (int side = 0; side < 2; ++side)
+	{
+		const int direction = east ? (side == 0 ? 2 : 6) : (side == 0 ? 4 : 0);
+		for (int z = 0; z < _mapZ; ++z)
+		{
+			int runStart = -1;
+			for (int i = 0; i <= length; ++i)
+			{
+				bool open = false;
+				if (i < length)
+				{
+					Position from = borderTile(i, z) + (side == 0 ? Position() : across);
+					Position next;
+					open = getStepCost(from, direction, unit, bam, next) != UnreachableCost;
+				}
+				if (open && runStart == -1)
+				{
+					runStart = i;
+				}
+				else if (!open && runStart != -1)
+				{
+					Position from = borderTile((runStart + i - 1) / 2, z) + (side == 0 ? Position() : across);
+					Position next;
+					const int cost = getStepCost(from, direction, unit, bam, next);
+					border.crossings.push_back({ _pathfinding->_save->getTileIndex(from), _pathfinding->_save->getTileIndex(next), cost });
+					runStart = -1;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Makes sure nodes and edges of cluster reflect current terrain.
+ * @param cluster Cluster index.
+ * @param unit Unit that move.
+ * @param bam Move type.
+ */
+void PathfindingGraph::updateCluster(int cluster, const BattleUnit *unit, BattleActionMove bam)
+{
+	const int cx = cluster % _clustersX;
+	const int cy = cluster / _clustersX;
+
+	// borders can mark this or neighbour clusters dirty
+	std::vector<const Border*> borders;
+	updateBorder(cluster, true, unit, bam);
+	updateBorder(cluster, false, unit, bam);
+	borders.push_back(&_bordersEast[cluster]);
+	borders.push_back(&_bordersSouth[cluster]);
+	if (cx > 0)
+	{
+		updateBorder(cluster - 1, true, unit, bam);
+		borders.push_back(&_bordersEast[cluster - 1]);
+	}
+	if (cy > 0)
+	{
+		updateBorder(cluster - _clustersX, false, unit, bam);
+		borders.push_back(&_bordersSouth[cluster - _clustersX]);
+	}
+
+	Cluster &c = _clusters[cluster];
+	if (!c.dirty)
+	{
+		return;
+	}
+	c.dirty = false;
+
+	c.nodes.clear();
+	for (const Border *border : borders)
+	{
+		for (const Crossing &crossing : border->crossings)
+		{
+			for (int tile : { crossing.from, crossing.to })
+			{
+				if (getCluster(getTilePosition(tile)) == cluster && std::find(c.nodes.begin(), c.nodes.end(), tile) == c.nodes.end())
+				{
+					c.nodes.push_back(tile);
+				}
+			}
+		}
+	}
+
+	const int x0 = cx * ClusterSize;
+	const int y0 = cy * ClusterSize;
+	const int w = std::min(ClusterSize, _mapX - x0);
+	const int h = std::min(ClusterSize, _mapY - y0);
+
+	c.edges.clear();
+	c.edges.resize(c.nodes.size());
+	std::vector<int> costs;
+	for (size_t n = 0; n < c.nodes.size(); ++n)
+	{
+		searchCluster(cluster, getTilePosition(c.nodes[n]), unit, bam, costs);
+		for (size_t m = 0; m < c.nodes.size(); ++m)
+		{
+			const Position p = getTilePosition(c.nodes[m]);
+			const int cost = costs[(p.z * h + (p.y - y0)) * w + (p.x - x0)];
+			if (m != n && cost != UnreachableCost)
+			{
+				c.edges[n].push_back({ c.nodes[m], cost });
+			}
+		}
+		for (const Border *border : borders)
+		{
+			for (const Crossing &crossing : border->crossings)
+			{
+				if (crossing.from == c.nodes[n])
+				{
+					c.edges[n].push_back({ crossing.to, crossing.cost });
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Marks clusters that could be affected by terrain change at given position.
+ * @param pos Position of changed tile.
+ */
+void PathfindingGraph::invalidate(Position pos)
+{
+	if (!isInitialized())
+	{
+		return;
+	}
+
+	// how far pathfinding can look from start tile.
+	const int range = 3;
+	for (int cy = std::max((pos.y - range) / ClusterSize, 0); cy <= std::min((pos.y + range) / ClusterSize, _clustersY - 1); ++cy)
+	{
+		for (int cx = std::max((pos.x - range) / ClusterSize, 0); cx <= std::min((pos.x + range) / ClusterSize, _clustersX - 1); ++cx)
+		{
+			const int cluster = cy * _clustersX + cx;
+			_clusters[cluster].dirty = true;
+			_bordersEast[cluster].dirty = true;
+			_bordersSouth[cluster].dirty = true;
+		}
+	}
+}
+
+/**
+ * Finds path on abstract graph and returns positions that a real path should go through.
+ * @param start Start position.
+ * @param end End position.
+ * @param unit Unit that move.
+ * @param bam Move type.
+ * @param waypoints Positions on path, without start and end.
+ * @return True if path was found.
+ */
+bool PathfindingGraph::findWaypoints(Position start, Position end, const BattleUnit *unit, BattleActionMove bam, std::vector<Position> &waypoints)
+{
+	waypoints.clear();
+
+	const int startCluster = getCluster(start);
+	const int endCluster = getCluster(end);
+	if (startCluster == endCluster)
+	{
+		return false;
+	}
+
+	updateCluster(startCluster, unit, bam);
+	updateCluster(endCluster, unit, bam);
+
+	// virtual nodes for start and end of path
+	const int startNode = -1;
+	const int endNode = -2;
+
+	struct SearchState
+	{
+		int cost;
+		int prev;
+		bool done;
+	};
+	std::unordered_map<int, SearchState> states;
+	Queue queue;
+	auto relax = [&](int tile, int cost, int prev)
+	{
+		auto it = states.find(tile);
+		if (it == states.end())
+		{
+			states[tile] = { cost, prev, false };
+			queue.push({ cost, tile });
+		}
+		else if (!it->second.done && cost < it->second.cost)
+		{
+			it->second = { cost, prev, false };
+			queue.push({ cost, tile });
+		}
+	};
+
+	std::vector<int> costs;
+	{
+		const Cluster &c = _clusters[startCluster];
+		searchCluster(startCluster, start, unit, bam, costs);
+		const int x0 = (startCluster % _clustersX) * ClusterSize;
+		const int y0 = (startCluster / _clustersX) * ClusterSize;
+		const int w = std::min(ClusterSize, _mapX - x0);
+		const int h = std::min(ClusterSize, _mapY - y0);
+		for (int tile : c.nodes)
+		{
+			const Position p = getTilePosition(tile);
+			const int cost = costs[(p.z * h + (p.y - y0)) * w + (p.x - x0)];
+			if (cost != UnreachableCost)
+			{
+				relax(tile, cost, startNode);
+			}
+		}
+	}
+
+	std::unordered_map<int, int> endCosts;
+	{
+		const Cluster &c = _clusters[endCluster];
+		const int x0 = (endCluster % _clustersX) * ClusterSize;
+		const int y0 = (endCluster / _clustersX) * ClusterSize;
+		const int w = std::min(ClusterSize, _mapX - x0);
+		const int h = std::min(ClusterSize, _mapY - y0);
+		for (int tile : c.nodes)
+		{
+			searchCluster(endCluster, getTilePosition(tile), unit, bam, costs);
+			const int cost = costs[(end.z * h + (end.y - y0)) * w + (end.x - x0)];
+			if (cost != UnreachableCost)
+			{
+				endCosts[tile] = cost;
+			}
+		}
+	}
+	if (endCosts.empty())
+	{
+		return false;
+	}
+
+	while (!queue.empty())
+	{
+		const QueueEntry top = queue.top();
+		queue.pop();
+		if (top.second == endNode)
+		{
+			break;
+		}
+		SearchState &state = states[top.second];
+		if (state.done || top.first != state.cost)
+		{
+			continue;
+		}
+		state.done = true;
+
+		const int cluster = getCluster(getTilePosition(top.second));
+		updateCluster(cluster, unit, bam);
+		const Cluster &c = _clusters[cluster];
+		auto node = std::find(c.nodes.begin(), c.nodes.end(), top.second);
+		if (node == c.nodes.end())
+		{
+			continue;
+		}
+		for (const Edge &edge : c.edges[node - c.nodes.begin()])
+		{
+			relax(edge.tile, top.first + edge.cost, top.second);
+		}
+		if (cluster == endCluster)
+		{
+			auto endCost = endCosts.find(top.second);
+			if (endCost != endCosts.end())
+			{
+				relax(endNode, top.first + endCost->second, top.second);
+			}
+		}
+	}
+
+	auto endState = states.find(endNode);
+	if (endState == states.end())
+	{
+		return false;
+	}
+	for (int tile = endState->second.prev; tile != startNode; tile = states[tile].prev)
+	{
+		waypoints.push_back(getTilePosition(tile));
+	}
+	std::reverse(waypoints.begin(), waypoints.end());
+	return true;
+}
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include "Position.h"
+
+namespace OpenXcom
+{
+
+class Pathfinding;
+class BattleUnit;
+enum BattleActionMove : char;
+
+/**
+ * Abstract graph over map block sized clusters of the battlescape, used to find long paths on big maps.
+ * Nodes are tiles where units can cross from one cluster to another, edges are
+ * moves between them inside one cluster or over cluster border.
+ * Graph depend only on terrain, units are handled when path is refined by normal A*.
+ * Clusters are built lazily and rebuilt when terrain near them changes.
+ */
+class PathfindingGraph
+{
+public:
+	/// Size of one cluster, same as map block.
+	static constexpr int ClusterSize = 10;
+
+private:
+	/// Edge of abstract graph.
+	struct Edge
+	{
+		int tile;
+		int cost;
+	};
+	/// Move over border between clusters.
+	struct Crossing
+	{
+		int from;
+		int to;
+		int cost;
+	};
+	/// Border between two neighbouring clusters.
+	struct Border
+	{
+		bool dirty = true;
+		/// Places where units can cross the border, in both directions.
+		std::vector<Crossing> crossings;
+	};
+	/// One map block column.
+	struct Cluster
+	{
+		bool dirty = true;
+		/// Tiles of this cluster used as graph nodes.
+		std::vector<int> nodes;
+		/// Edges for each node.
+		std::vector<std::vector<Edge>> edges;
+	};
+
+	Pathfinding *_pathfinding;
+	int _mapX, _mapY, _mapZ;
+	int _clustersX, _clustersY;
+	std::vector<Cluster> _clusters;
+	/// Borders to east neighbour, one for each cluster.
+	std::vector<Border> _bordersEast;
+	/// Borders to south neighbour, one for each cluster.
+	std::vector<Border> _bordersSouth;
+
+	/// Gets cluster index of a position.
+	int getCluster(Position pos) const { return (pos.y / ClusterSize) * _clustersX + (pos.x / ClusterSize); }
+	/// Converts tile index to position.
+	Position getTilePosition(int tile) const;
+	/// Gets cost of one step using only terrain.
+	int getStepCost(Position pos, int direction, const BattleUnit *unit, BattleActionMove bam, Position &next) const;
+	/// Calculates costs of reaching tiles of a cluster from a given tile.
+	void searchCluster(int cluster, Position start, const BattleUnit *unit, BattleActionMove bam, std::vector<int> &costs) const;
+	/// Recalculates crossings of a border.
+	void updateBorder(int cluster, bool east, const BattleUnit *unit, BattleActionMove bam);
+	/// Makes sure cluster nodes and edges are up to date.
+	void updateCluster(int cluster, const BattleUnit *unit, BattleActionMove bam);
+
+public:
+	/// Creates empty graph.
+	PathfindingGraph();
+	/// Cleans up the graph.
+	~PathfindingGraph();
+	/// Sets up graph for given map.
+	void init(Pathfinding *pathfinding, int mapX, int mapY, int mapZ);
+	/// Is graph set up?
+	bool isInitialized() const { return _pathfinding != nullptr; }
+	/// Marks clusters that could be affected by terrain change at position.
+	void invalidate(Position pos);
+	/// Finds list of positions that a path from start to end should pass through.
+	bool findWaypoints(Position start, Position end, const BattleUnit *unit, BattleActionMove bam, std::vector<Position> &waypoints);
+};
+
+}
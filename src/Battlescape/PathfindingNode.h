@@ -23,7 +23,6 @@ namespace OpenXcom
 {
 
 class PathfindingOpenSet;
-struct OpenSetEntry;
 
 /**
  * Cost of one step.
@@ -93,8 +92,9 @@ private:
 	Sint16 _tuGuess;
 	/// Is best path find for this tile.
 	bool _checked;
-	// Invasive field needed by PathfindingOpenSet
-	Uint8 _openentry;
+	// Invasive fields needed by PathfindingOpenSet, bucket and position in it.
+	int _openBucket;
+	int _openIndex;
 	friend class PathfindingOpenSet;
 public:
 	/// Creates a new PathfindingNode class.
@@ -116,7 +116,7 @@ public:
 	/// Gets the previous walking direction.
 	int getPrevDir() const;
 	/// Is this node already in a PathfindingOpenSet?
-	bool inOpenSet() const { return (_openentry != 0); }
+	bool inOpenSet() const { return (_openBucket >= 0); }
 	/// Gets the approximate cost to reach the target position.
 	int getTUGuess() const { return _tuGuess; }
 
@@ -17,12 +17,21 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <assert.h>
+#include <algorithm>
 #include "PathfindingOpenSet.h"
 #include "PathfindingNode.h"
 
 namespace OpenXcom
 {
 
+/**
+ * Creates empty set.
+ */
+PathfindingOpenSet::PathfindingOpenSet() : _minBucket(0), _maxBucket(0), _size(0)
+{
+
+}
+
 /**
  * Cleans up all the entries still in set.
  */
@@ -32,50 +41,102 @@ PathfindingOpenSet::~PathfindingOpenSet()
 }
 
 /**
- * Keeps removing all discarded entries that have come to the top of the queue.
+ * Removes all nodes from set. Nodes itself are not updated,
+ * they need be reset before they are used again.
  */
-void PathfindingOpenSet::removeDiscarded()
+void PathfindingOpenSet::clear()
 {
-	while (!_queue.empty() && _queue.top()._node->_openentry != _queue.top()._openentry)
+	if (_size > 0)
 	{
-		_queue.pop();
+		for (size_t i = _minBucket; i <= _maxBucket && i < _buckets.size(); ++i)
+		{
+			_buckets[i].clear();
+		}
 	}
+	_minBucket = 0;
+	_maxBucket = 0;
+	_size = 0;
+}
+
+/**
+ * Removes node from bucket it is currently in.
+ * Last node in bucket takes its place.
+ * @param node Node in this set.
+ */
+void PathfindingOpenSet::remove(PathfindingNode *node)
+{
+	std::vector<PathfindingNode*> &bucket = _buckets[node->_openBucket];
+	PathfindingNode *last = bucket.back();
+	bucket[node->_openIndex] = last;
+	last->_openIndex = node->_openIndex;
+	bucket.pop_back();
+	node->_openBucket = -1;
+	--_size;
 }
 
 /**
  * Gets the node with the least cost.
- * After this call, the node is no longer in the set. It is an error to call this when the set is empty.
+ * After this call, the node is no longer in the set.
  * @return A pointer to the node which had the least cost.
  */
 PathfindingNode *PathfindingOpenSet::pop()
 {
 	assert(!empty());
 
-	PathfindingNode *nd = _queue.top()._node;
-	_queue.pop();
-	nd->_openentry = 0;
+	while (_buckets[_minBucket].empty())
+	{
+		++_minBucket;
+	}
 
-	// Discarded entries might be visible now.
-	removeDiscarded();
+	std::vector<PathfindingNode*> &bucket = _buckets[_minBucket];
+	PathfindingNode *nd = bucket.back();
+	bucket.pop_back();
+	nd->_openBucket = -1;
+	--_size;
 	return nd;
 }
 
 /**
  * Places the node in the set.
- * If the node was already in the set, the previous entry is discarded.
- * It is the caller's responsibility to never re-add a node with a worse cost.
+ * If the node was already in the set, it is moved to bucket matching its new cost.
  * @param node A pointer to the node to add.
  */
 void PathfindingOpenSet::push(PathfindingNode *node)
 {
-	assert(node->_openentry != 255u);
+	int cost = node->getTUCost(false).time * 4 + node->getTUGuess(); //HACK: this is not real cost, more rough approximation for algorithm, as bonus `getTUGuess` work more like gravity/potential than normal cost.
+	cost = std::max(cost, 0);
 
-	OpenSetEntry entry = {};
-	entry._node = node;
-	entry._cost = node->getTUCost(false).time * 4 + node->getTUGuess(); //HACK: this is not real cost, more rough approximation for algorithm, as bonus `getTUGuess` work more like gravity/potential than normal cost.
-	entry._openentry = ++node->_openentry; // next unique number, used to check if old recode is still valid.
-	_queue.push(entry);
-}
+	if (node->inOpenSet())
+	{
+		if (node->_openBucket == cost)
+		{
+			return;
+		}
+		remove(node);
+	}
+
+	const size_t index = (size_t)cost;
+	if (index >= _buckets.size())
+	{
+		_buckets.resize(index + 1);
+	}
+	if (_size == 0)
+	{
+		_minBucket = index;
+		_maxBucket = index;
+	}
+	else
+	{
+		// guess is not consistent and can lower cost below already checked nodes.
+		_minBucket = std::min(_minBucket, index);
+		_maxBucket = std::max(_maxBucket, index);
+	}
 
+	std::vector<PathfindingNode*> &bucket = _buckets[index];
+	node->_openBucket = cost;
+	node->_openIndex = (int)bucket.size();
+	bucket.push_back(node);
+	++_size;
+}
 
 }
@@ -17,59 +17,48 @@
  * You should have received a copy of the GNU General Public License
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <queue>
-#include <SDL_stdinc.h>
+#include <vector>
+#include <cstddef>
 
 namespace OpenXcom
 {
 
 class PathfindingNode;
 
-struct OpenSetEntry
-{
-	PathfindingNode *_node;
-	Sint16 _cost;
-	Uint8 _openentry;
-};
-
-/**
- * Helper class to compare entries through pointers.
- */
-class EntryCompare
-{
-public:
-	/**
-	 * Compares entries @a *a and @a *b.
-	 * @param a Pointer to first entry.
-	 * @param b Pointer to second entry.
-	 * @return True if entry @a *b must come before @a *a.
-	 */
-	bool operator()(const OpenSetEntry& a, const OpenSetEntry& b) const
-	{
-		return b._cost < a._cost;
-	}
-};
-
 /**
  * A class that holds references to the nodes to be examined in pathfinding.
+ * Nodes are kept in buckets indexed by cost, as costs are small integers
+ * this give constant time push and pop, and a node that get better cost
+ * is moved to new bucket instead of leaving stale entry behind.
  */
 class PathfindingOpenSet
 {
 public:
+	/// Creates empty set.
+	PathfindingOpenSet();
 	/// Cleans up the set and frees allocated memory.
 	~PathfindingOpenSet();
 	/// Gets the next node to check.
 	PathfindingNode *pop();
-	/// Adds a node to the set.
+	/// Adds a node to the set or updates its cost.
 	void push(PathfindingNode *node);
 	/// Is the set empty?
-	bool empty() const { return _queue.empty(); }
+	bool empty() const { return _size == 0; }
+	/// Removes all nodes, keeps allocated memory for reuse.
+	void clear();
 
 private:
-	std::priority_queue<OpenSetEntry, std::vector<OpenSetEntry>, EntryCompare> _queue;
+	/// Nodes grouped by cost, index is cost.
+	std::vector<std::vector<PathfindingNode*>> _buckets;
+	/// Lowest bucket that could have any nodes.
+	size_t _minBucket;
+	/// Highest bucket used since last clear.
+	size_t _maxBucket;
+	/// Number of nodes in set.
+	size_t _size;
 
-	/// Removes reachable discarded entries.
-	void removeDiscarded();
+	/// Removes node from its current bucket.
+	void remove(PathfindingNode *node);
 };
 
 }
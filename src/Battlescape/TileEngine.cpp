@@ -32,6 +32,7 @@
 #include "../Savegame/HitLog.h"
 #include "../Engine/RNG.h"
 #include "../Engine/GraphSubset.h"
+#include "../Engine/ThreadPool.h"
 #include "BattlescapeState.h"
 #include "../Mod/MapDataSet.h"
 #include "../Mod/Unit.h"
@@ -42,6 +43,7 @@
 #include "../Engine/Options.h"
 #include "ProjectileFlyBState.h"
 #include "MeleeAttackBState.h"
+#include "BattleProfiler.h"
 #include "../fmath.h"
 
 namespace OpenXcom
@@ -889,7 +891,7 @@ constexpr Position TileEngine::voxelTileCenter;
  * @param maxDarknessToSeeUnits Threshold of darkness for LoS calculation.
  */
 TileEngine::TileEngine(SavedBattleGame *save, Mod *mod) :
-	_save(save), _voxelData(mod->getVoxelData()), _inventorySlotGround(mod->getInventoryGround()), _personalLighting(true), _cacheTile(0), _cacheTileBelow(0),
+	_save(save), _voxelData(mod->getVoxelData()), _inventorySlotGround(mod->getInventoryGround()), _personalLighting(true),
 	_maxViewDistance(mod->getMaxViewDistance()), _maxViewDistanceSq(_maxViewDistance * _maxViewDistance),
 	_maxVoxelViewDistance(_maxViewDistance * 16), _maxDarknessToSeeUnits(mod->getMaxDarknessToSeeUnits()),
 	_maxStaticLightDistance(mod->getMaxStaticLightDistance()), _maxDynamicLightDistance(mod->getMaxDynamicLightDistance()),
@@ -898,7 +900,9 @@ TileEngine::TileEngine(SavedBattleGame *save, Mod *mod) :
 	_blockVisibility.resize(save->getMapSizeXYZ());
 	_lightPropagationTerrainBlocking.resize(save->getMapSizeXYZ());
 	_lightPropagationTempNeedUpdate.resize(save->getMapSizeXYZ());
-	_cacheTilePos = invalid;
+	_unitLightCount.resize(save->getMapSizeXYZ());
+	_unitLightTemp.resize(save->getMapSizeXYZ());
+	_workerScratch.resize(ThreadPool::getShared().getWorkerCount());
 
 	if (Options::oxceTogglePersonalLightType == 2)
 	{
@@ -924,6 +928,15 @@ TileEngine::~TileEngine()
 
 }
 
+/**
+ * Gets data dedicated for worker thread that calls this function.
+ * @return Data that is safe to modify from current thread.
+ */
+TileEngine::WorkerScratch &TileEngine::getWorkerScratch()
+{
+	return _workerScratch[ThreadPool::getCurrentWorker()];
+}
+
 /**
   * Calculates sun shading for the whole terrain.
   */
@@ -1050,58 +1063,153 @@ void TileEngine::calculateTerrainItems(MapSubset gs)
 }
 
 /**
-  * Recalculates lighting for the units.
-  */
-void TileEngine::calculateUnitLighting(MapSubset gs)
+ * Gets power of light emitted by unit, from its armor, weapons and fire.
+ * @param unit Unit.
+ * @return Light power, zero if unit do not emit any light.
+ */
+int TileEngine::getUnitLightPower(const BattleUnit *unit) const
 {
-	for (BattleUnit *unit : *_save->getUnits())
+	if (unit->isOut())
+	{
+		return 0;
+	}
+
+	int currLight = 0;
+	// add lighting of soldiers
+	if (_personalLighting && unit->getFaction() == FACTION_PLAYER)
+	{
+		currLight = std::max(currLight, unit->getArmor()->getPersonalLight());
+	}
+	const BattleItem *handWeapons[] = { unit->getLeftHandWeapon(), unit->getRightHandWeapon() };
+	for (const BattleItem *w : handWeapons)
 	{
-		if (unit->isOut())
+		if (!w) continue;
+
+		if (w->getGlow())
 		{
-			continue;
+			currLight = std::max(currLight, w->getGlowRange());
 		}
 
-		int currLight = 0;
-		// add lighting of soldiers
-		if (_personalLighting && unit->getFaction() == FACTION_PLAYER)
+		auto* u = w->getUnit();
+		if (u && u->getFire())
 		{
-			currLight = std::max(currLight, unit->getArmor()->getPersonalLight());
+			currLight = std::max(currLight, unitFireLightPowerStunned);
 		}
-		const BattleItem *handWeapons[] = { unit->getLeftHandWeapon(), unit->getRightHandWeapon() };
-		for (const BattleItem *w : handWeapons)
-		{
-			if (!w) continue;
+	}
+	// add lighting of units on fire
+	if (unit->getFire())
+	{
+		currLight = std::max(currLight, unitFireLightPower);
+	}
 
-			if (w->getGlow())
-			{
-				currLight = std::max(currLight, w->getGlowRange());
-			}
+	if (currLight >= getMaxDynamicLightDistance())
+	{
+		currLight = getMaxDynamicLightDistance() - 1;
+	}
+	return currLight;
+}
 
-			auto* u = w->getUnit();
-			if (u && u->getFire())
+/**
+ * Adds light of one unit to light counters and unit light layer of tiles.
+ * @param light Light calculated by `addLight`.
+ */
+void TileEngine::applyUnitLight(const UnitLight &light)
+{
+	for (const auto& p : light.tiles)
+	{
+		++_unitLightCount[p.first][p.second];
+		_save->getTile(p.first)->addLight(p.second, LL_UNITS);
+	}
+}
+
+/**
+ * Removes light of one unit from light counters and unit light layer of tiles.
+ * Tiles that lost their brightest light get next brightest light of other units.
+ * @param light Light previously added by `applyUnitLight`.
+ */
+void TileEngine::removeUnitLight(const UnitLight &light)
+{
+	for (const auto& p : light.tiles)
+	{
+		auto& count = _unitLightCount[p.first];
+		auto* tile = _save->getTile(p.first);
+		if (--count[p.second] == 0 && tile->getLight(LL_UNITS) == p.second)
+		{
+			tile->resetLight(LL_UNITS);
+			for (int level = p.second - 1; level > 0; --level)
 			{
-				currLight = std::max(currLight, unitFireLightPowerStunned);
+				if (count[level])
+				{
+					tile->addLight(level, LL_UNITS);
+					break;
+				}
 			}
 		}
-		// add lighting of units on fire
-		if (unit->getFire())
+	}
+}
+
+/**
+  * Recalculates lighting for the units.
+  * Light of each unit is remembered and only units that moved, changed light power
+  * or lit area where other light layers or terrain changed are recalculated.
+  * @param changedArea Area where lower light layers or terrain changed, empty if only units changed.
+  */
+void TileEngine::calculateUnitLighting(MapSubset changedArea)
+{
+	const auto& units = *_save->getUnits();
+
+	// units could be removed from battle, forget their light
+	while (_unitLights.size() > units.size())
+	{
+		removeUnitLight(_unitLights.back());
+		_unitLights.pop_back();
+	}
+	_unitLights.resize(units.size());
+
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		const BattleUnit *unit = units[i];
+		UnitLight& light = _unitLights[i];
+
+		const auto size = unit->getArmor()->getSize();
+		const auto pos = unit->getPosition();
+		const auto power = pos != invalid ? getUnitLightPower(unit) : 0;
+
+		if (light.unit == unit && light.position == pos && light.power == power)
 		{
-			currLight = std::max(currLight, unitFireLightPower);
+			if (power == 0 || !MapSubset::intersection(changedArea, mapArea(pos, power + size - 1)))
+			{
+				continue;
+			}
 		}
 
-		if (currLight >= getMaxDynamicLightDistance())
+		removeUnitLight(light);
+		light.unit = unit;
+		light.position = pos;
+		light.power = power;
+		light.tiles.clear();
+
+		if (power == 0)
 		{
-			currLight = getMaxDynamicLightDistance() - 1;
+			continue;
 		}
-		const auto size = unit->getArmor()->getSize();
-		const auto pos = unit->getPosition();
+
+		const auto gsMap = MapSubset{ _save->getMapSizeX(), _save->getMapSizeY() };
 		for (int x = 0; x < size; ++x)
 		{
 			for (int y = 0; y < size; ++y)
 			{
-				addLight(gs, pos + Position(x, y, 0), currLight, LL_UNITS);
+				addLight(gsMap, pos + Position(x, y, 0), power, LL_UNITS, &light);
 			}
 		}
+		for (auto& p : light.tiles)
+		{
+			auto& temp = _unitLightTemp[p.first];
+			p.second = static_cast<Uint8>(std::min((int)temp, UnitLightLevels - 1));
+			temp = 0;
+		}
+
+		applyUnitLight(light);
 	}
 }
 
@@ -1186,33 +1294,43 @@ void TileEngine::calculateLighting(LightLayers layer, Position position, int eve
 		);
 	}
 
-	iterateTilesLightMaxBound(_save, position, eventRadius, getMaxDynamicLightDistance(), gsMap, _lightPropagationTempNeedUpdate, _lightPropagationTerrainBlocking);
-
-	if (layer <= LL_FIRE)
+	// light of units is tracked separately for each unit, other layers are recalculated in whole affected area
+	if (layer <= LL_ITEMS)
 	{
+		iterateTilesLightMaxBound(_save, position, eventRadius, getMaxDynamicLightDistance(), gsMap, _lightPropagationTempNeedUpdate, _lightPropagationTerrainBlocking);
+
+		if (layer <= LL_FIRE)
+		{
+			iterateTiles(
+				_save,
+				gsStatic,
+				[&](Tile* tile, int index)
+				{
+					if (_lightPropagationTempNeedUpdate[index])
+					{
+						for (int l = layer; l < LL_UNITS; ++l)
+						{
+							tile->resetLight((LightLayers)l);
+						}
+					}
+				}
+			);
+		}
+
 		iterateTiles(
 			_save,
-			gsStatic,
+			gsDynamic,
 			[&](Tile* tile, int index)
 			{
-				if (_lightPropagationTempNeedUpdate[index]) tile->resetLightMulti(layer);
+				if (_lightPropagationTempNeedUpdate[index]) tile->resetLight(LL_ITEMS);
 			}
 		);
 	}
 
-	iterateTiles(
-		_save,
-		gsDynamic,
-		[&](Tile* tile, int index)
-		{
-			if (_lightPropagationTempNeedUpdate[index]) tile->resetLightMulti(std::max(layer, LL_ITEMS));
-		}
-	);
-
 	if (layer <= LL_AMBIENT) calculateSunShading(gsStatic);
 	if (layer <= LL_FIRE) calculateTerrainBackground(gsStatic);
 	if (layer <= LL_ITEMS) calculateTerrainItems(gsDynamic);
-	if (layer <= LL_UNITS) calculateUnitLighting(gsDynamic);
+	calculateUnitLighting(layer <= LL_FIRE ? gsStatic : layer <= LL_ITEMS ? gsDynamic : terrianChanged ? (position != invalid ? mapArea(position, eventRadius + 1) : gsMap) : MapSubset{});
 }
 
 /**
@@ -1220,8 +1338,9 @@ void TileEngine::calculateLighting(LightLayers layer, Position position, int eve
  * @param center Center.
  * @param power Power.
  * @param layer Light is separated in 4 layers: Ambient, Tiles, Items, Units.
+ * @param source If set, light of unit is stored there instead of tiles, ignoring light of other units.
  */
-void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers layer)
+void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers layer, UnitLight *source)
 {
 	if (power <= 0)
 	{
@@ -1251,8 +1370,23 @@ void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers
 			const auto target = tile->getPosition();
 			const auto diff = target - center;
 			const auto distance = (int)Round(Position::distance(target.toVoxel(), center.toVoxel()) / Position::TileXY);
-			const auto targetLight = tile->getLightMulti(layer);
+			const auto targetLight = source ? std::max(tile->getLightMulti(LL_ITEMS), (int)_unitLightTemp[idx]) : tile->getLightMulti(layer);
 			auto currLight = power - distance;
+			auto setLight = [&](int light)
+			{
+				if (source)
+				{
+					if (_unitLightTemp[idx] == 0)
+					{
+						source->tiles.push_back(std::make_pair(idx, 0));
+					}
+					_unitLightTemp[idx] = light;
+				}
+				else
+				{
+					tile->addLight(light, layer);
+				}
+			};
 
 			if (currLight <= targetLight)
 			{
@@ -1260,10 +1394,10 @@ void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers
 			}
 			if (clasicLighting)
 			{
-				tile->addLight(currLight, layer);
+				setLight(currLight);
 				return;
 			}
-			if (_lightPropagationTempNeedUpdate[idx] == 0)
+			if (!source && _lightPropagationTempNeedUpdate[idx] == 0)
 			{
 				return;
 			}
@@ -1358,7 +1492,7 @@ void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers
 			currLight = (lightA + lightB) / 2;
 			if (currLight > targetLight)
 			{
-				tile->addLight(currLight, layer);
+				setLight(currLight);
 			}
 		}
 	);
@@ -1378,9 +1512,10 @@ void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers
 */
 bool TileEngine::setupEventVisibilitySector(const Position &observerPos, const Position &eventPos, const int &eventRadius)
 {
+	WorkerScratch &scratch = getWorkerScratch();
 	if (eventRadius == 0 || eventPos == Position(-1, -1, -1) || Position::distance2dSq(observerPos, eventPos) <= eventRadius * eventRadius)
 	{
-		_eventVisibilityObserverPos = Position{ -1, -1, -1 };
+		scratch.eventVisibilityObserverPos = Position{ -1, -1, -1 };
 		return true;
 	}
 	else
@@ -1394,11 +1529,11 @@ bool TileEngine::setupEventVisibilitySector(const Position &observerPos, const P
 		float t1 = b - a;
 		float t2 = b + a;
 		//Define the points where the lines tangent to the circle intersect it. Note: resulting positions are relative to observer, not in direct tile space.
-		_eventVisibilitySectorL.x = roundf(eventPos.x + eventRadius * sinf(t1)) - observerPos.x;
-		_eventVisibilitySectorL.y = roundf(eventPos.y - eventRadius * cosf(t1)) - observerPos.y;
-		_eventVisibilitySectorR.x = roundf(eventPos.x - eventRadius * sinf(t2)) - observerPos.x;
-		_eventVisibilitySectorR.y = roundf(eventPos.y + eventRadius * cosf(t2)) - observerPos.y;
-		_eventVisibilityObserverPos = observerPos;
+		scratch.eventVisibilitySectorL.x = roundf(eventPos.x + eventRadius * sinf(t1)) - observerPos.x;
+		scratch.eventVisibilitySectorL.y = roundf(eventPos.y - eventRadius * cosf(t1)) - observerPos.y;
+		scratch.eventVisibilitySectorR.x = roundf(eventPos.x - eventRadius * sinf(t2)) - observerPos.x;
+		scratch.eventVisibilitySectorR.y = roundf(eventPos.y + eventRadius * cosf(t2)) - observerPos.y;
+		scratch.eventVisibilityObserverPos = observerPos;
 		return false;
 	}
 }
@@ -1409,14 +1544,15 @@ bool TileEngine::setupEventVisibilitySector(const Position &observerPos, const P
  * @param toCheck The position to check.
  * @return true if within the circle sector.
  */
-inline bool TileEngine::inEventVisibilitySector(const Position &toCheck) const
+inline bool TileEngine::inEventVisibilitySector(const Position &toCheck)
 {
-	if (_eventVisibilityObserverPos != Position{ -1, -1, -1 })
+	const WorkerScratch &scratch = getWorkerScratch();
+	if (scratch.eventVisibilityObserverPos != Position{ -1, -1, -1 })
 	{
-		Position posDiff = toCheck - _eventVisibilityObserverPos;
+		Position posDiff = toCheck - scratch.eventVisibilityObserverPos;
 		//Is toCheck within the arc as defined by the two tangent points?
-		return (!(-_eventVisibilitySectorL.x * posDiff.y + _eventVisibilitySectorL.y * posDiff.x > 0) &&
-			(-_eventVisibilitySectorR.x * posDiff.y + _eventVisibilitySectorR.y * posDiff.x > 0));
+		return (!(-scratch.eventVisibilitySectorL.x * posDiff.y + scratch.eventVisibilitySectorL.y * posDiff.x > 0) &&
+			(-scratch.eventVisibilitySectorR.x * posDiff.y + scratch.eventVisibilitySectorR.y * posDiff.x > 0));
 	}
 	else
 	{
@@ -1425,28 +1561,33 @@ inline bool TileEngine::inEventVisibilitySector(const Position &toCheck) const
 }
 
 /**
-* Updates line of sight of a single soldier in a narrow arc around a given event position.
+* Finds units visible to a single soldier in a narrow arc around a given event position.
+* Does not change any unit, result need be applied by `applyUnitsInFOV`, this allow calling it from worker threads.
 * @param unit Unit to check line of sight of.
 * @param eventPos The centre of the event which necessitated the FOV update. Used to optimize which tiles to update.
 * @param eventRadius The radius of a circle able to fully encompass the event, in tiles. Hence: 1 for a single tile event.
-* @return True when new aliens are spotted.
+* @param fov Buffer for found units.
 */
-bool TileEngine::calculateUnitsInFOV(BattleUnit* unit, const Position eventPos, const int eventRadius)
+void TileEngine::findUnitsInFOV(BattleUnit* unit, const Position eventPos, const int eventRadius, FieldOfView &fov)
 {
-	size_t oldNumVisibleUnits = unit->getUnitsSpottedThisTurn().size();
+	fov.units.clear();
+	fov.unitsClear = false;
+	fov.unitsSkip = true;
+
 	bool useTurretDirection = false;
 	if (Options::strafe && (unit->getTurretType() > -1)) {
 		useTurretDirection = true;
 	}
 
 	if (unit->isOut())
-		return false;
+		return;
 
+	fov.unitsSkip = false;
 	Position posSelf = unit->getPosition();
 	if (setupEventVisibilitySector(posSelf, eventPos, eventRadius))
 	{
 		//Asked to do a full check. Or the event is overlapping our tile. Better check everything.
-		unit->clearVisibleUnits();
+		fov.unitsClear = true;
 	}
 
 	//Loop through all units specified and figure out which ones we can actually see.
@@ -1467,42 +1608,72 @@ bool TileEngine::calculateUnitsInFOV(BattleUnit* unit, const Position eventPos,
 						if (!unit->checkViewSector(posToCheck, useTurretDirection))
 						{
 							//Unit within arc, but not in view sector. If it just walked out we need to remove it.
-							unit->removeFromVisibleUnits((*i));
+							fov.units.push_back(std::make_pair(*i, false));
 						}
 						else if (visible(unit, _save->getTile(posToCheck))) // (distance is checked here)
 						{
-							//Unit (or part thereof) visible to one or more eyes of this unit.
-							if (unit->getFaction() == FACTION_PLAYER)
-							{
-								(*i)->setVisible(true);
-							}
-							if ((( (*i)->getFaction() == FACTION_HOSTILE && unit->getFaction() == FACTION_PLAYER )
-								|| ( (*i)->getFaction() != FACTION_HOSTILE && unit->getFaction() == FACTION_HOSTILE ))
-								&& !unit->hasVisibleUnit((*i)))
-							{
-								unit->addToVisibleUnits((*i));
-								unit->addToVisibleTiles((*i)->getTile());
-
-								if (unit->getFaction() == FACTION_HOSTILE && (*i)->getFaction() != FACTION_HOSTILE)
-								{
-									(*i)->setTurnsSinceSpotted(0);
-
-									(*i)->setTurnsLeftSpottedForSnipers(std::max(unit->getSpotterDuration(), (*i)->getTurnsLeftSpottedForSnipers())); // defaults to 0 = no information given to snipers
-								}
-							}
+							fov.units.push_back(std::make_pair(*i, true));
 
 							x = y = sizeOther; //If a unit's tile is visible there's no need to check the others: break the loops.
 						}
 						else
 						{
 							//Within arc, but not visible. Need to check to see if whatever happened at eventPos blocked a previously seen unit.
-							unit->removeFromVisibleUnits((*i));
+							fov.units.push_back(std::make_pair(*i, false));
 						}
 					}
 				}
 			}
 		}
 	}
+}
+
+/**
+* Updates visible units of a single soldier using result of `findUnitsInFOV`.
+* @param unit Unit to update.
+* @param fov Units found for this unit.
+* @return True when new aliens are spotted.
+*/
+bool TileEngine::applyUnitsInFOV(BattleUnit* unit, const FieldOfView &fov)
+{
+	if (fov.unitsSkip)
+		return false;
+
+	size_t oldNumVisibleUnits = unit->getUnitsSpottedThisTurn().size();
+	if (fov.unitsClear)
+	{
+		unit->clearVisibleUnits();
+	}
+
+	for (const auto& check : fov.units)
+	{
+		BattleUnit *other = check.first;
+		if (!check.second)
+		{
+			unit->removeFromVisibleUnits(other);
+			continue;
+		}
+
+		//Unit (or part thereof) visible to one or more eyes of this unit.
+		if (unit->getFaction() == FACTION_PLAYER)
+		{
+			other->setVisible(true);
+		}
+		if ((( other->getFaction() == FACTION_HOSTILE && unit->getFaction() == FACTION_PLAYER )
+			|| ( other->getFaction() != FACTION_HOSTILE && unit->getFaction() == FACTION_HOSTILE ))
+			&& !unit->hasVisibleUnit(other))
+		{
+			unit->addToVisibleUnits(other);
+			unit->addToVisibleTiles(other->getTile());
+
+			if (unit->getFaction() == FACTION_HOSTILE && other->getFaction() != FACTION_HOSTILE)
+			{
+				other->setTurnsSinceSpotted(0);
+
+				other->setTurnsLeftSpottedForSnipers(std::max(unit->getSpotterDuration(), other->getTurnsLeftSpottedForSnipers())); // defaults to 0 = no information given to snipers
+			}
+		}
+	}
 	// we only react when there are at least the same amount of visible units as before AND the checksum is different
 	// this way we stop if there are the same amount of visible units, but a different unit is seen
 	// or we stop if there are more visible units seen
@@ -1514,15 +1685,35 @@ bool TileEngine::calculateUnitsInFOV(BattleUnit* unit, const Position eventPos,
 }
 
 /**
-* Calculates line of sight of tiles for a player controlled soldier.
+* Updates line of sight of a single soldier in a narrow arc around a given event position.
+* @param unit Unit to check line of sight of.
+* @param eventPos The centre of the event which necessitated the FOV update. Used to optimize which tiles to update.
+* @param eventRadius The radius of a circle able to fully encompass the event, in tiles. Hence: 1 for a single tile event.
+* @return True when new aliens are spotted.
+*/
+bool TileEngine::calculateUnitsInFOV(BattleUnit* unit, const Position eventPos, const int eventRadius)
+{
+	FieldOfView fov;
+	findUnitsInFOV(unit, eventPos, eventRadius, fov);
+	return applyUnitsInFOV(unit, fov);
+}
+
+/**
+* Finds tiles in line of sight of a player controlled soldier.
+* Does not change unit or tiles, result need be applied by `applyTilesInFOV`, this allow calling it from worker threads.
 * If supplied with an event position differing from the soldier's position, it will only
 * calculate tiles within a narrow arc.
 * @param unit Unit to check line of sight of.
 * @param eventPos The centre of the event which necessitated the FOV update. Used to optimize which tiles to update.
 * @param eventRadius The radius of a circle able to fully encompass the event, in tiles. Hence: 1 for a single tile event.
+* @param fov Buffer for found tiles.
 */
-void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius)
+void TileEngine::findTilesInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius, FieldOfView &fov)
 {
+	fov.tiles.clear();
+	fov.tilesClear = false;
+	fov.tilesSkip = true;
+
 	bool useTurretDirection = false;
 	bool skipNarrowArcTest = false;
 	int direction;
@@ -1541,14 +1732,16 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 	}
 	else if (unit->isOut())
 	{
-		unit->clearVisibleTiles();
+		fov.tilesSkip = false;
+		fov.tilesClear = true;
 		return;
 	}
+	fov.tilesSkip = false;
 	Position posSelf = unit->getPosition();
 	if (setupEventVisibilitySector(posSelf, eventPos, eventRadius))
 	{
 		//Asked to do a full check. Or unit within event. Should update all.
-		unit->clearVisibleTiles();
+		fov.tilesClear = true;
 		skipNarrowArcTest = true;
 	}
 
@@ -1557,7 +1750,10 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 
 	//Variables for finding the tiles to test based on the view direction.
 	Position posTest;
-	std::vector<Position> _trajectory;
+	WorkerScratch &scratch = getWorkerScratch();
+	std::vector<Position> &_trajectory = scratch.trajectory;
+	std::vector<Uint8> &visitedTiles = scratch.visitedTiles;
+	visitedTiles.resize(_save->getMapSizeXYZ());
 	bool swap = (direction == 0 || direction == 4);
 	const int signX[8] = { +1, +1, +1, +1, -1, -1, -1, -1 };
 	const int signY[8] = { -1, -1, -1, +1, +1, +1, -1, -1 };
@@ -1618,20 +1814,12 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 									//Reveal all tiles along line of vision. Note: needed due to width of bresenham stroke.
 									for (std::vector<Position>::iterator i = _trajectory.begin(); i != _trajectory.end(); ++i)
 									{
-										Position posVisited = (*i);
-										//Add tiles to the visible list only once. BUT we still need to calculate the whole trajectory as
-										// this bresenham line's period might be different from the one that originally revealed the tile.
-										if (!unit->hasVisibleTile(_save->getTile(posVisited)))
+										//Remember tiles only once, in order they were reached first time.
+										const int index = _save->getTileIndex(*i);
+										if (!visitedTiles[index])
 										{
-											unit->addToVisibleTiles(_save->getTile(posVisited));
-											_save->getTile(posVisited)->setVisible(+1);
-											_save->getTile(posVisited)->setDiscovered(true, O_FLOOR);
-
-											// walls to the east or south of a visible tile, we see that too
-											Tile* t = _save->getTile(Position(posVisited.x + 1, posVisited.y, posVisited.z));
-											if (t) t->setDiscovered(true, O_WESTWALL);
-											t = _save->getTile(Position(posVisited.x, posVisited.y + 1, posVisited.z));
-											if (t) t->setDiscovered(true, O_NORTHWALL);
+											visitedTiles[index] = 1;
+											fov.tiles.push_back(_save->getTile(index));
 										}
 									}
 								}
@@ -1642,6 +1830,124 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 			}
 		}
 	}
+
+	for (Tile *tile : fov.tiles)
+	{
+		visitedTiles[_save->getTileIndex(tile->getPosition())] = 0;
+	}
+}
+
+/**
+* Updates visible tiles of a player controlled soldier using result of `findTilesInFOV`.
+* @param unit Unit to update.
+* @param fov Tiles found for this unit.
+*/
+void TileEngine::applyTilesInFOV(BattleUnit *unit, const FieldOfView &fov)
+{
+	if (fov.tilesSkip)
+		return;
+
+	if (fov.tilesClear)
+	{
+		unit->clearVisibleTiles();
+	}
+
+	for (Tile *tile : fov.tiles)
+	{
+		//Add tiles to the visible list only once. BUT we still need to calculate the whole trajectory as
+		// this bresenham line's period might be different from the one that originally revealed the tile.
+		if (!unit->hasVisibleTile(tile))
+		{
+			Position posVisited = tile->getPosition();
+			unit->addToVisibleTiles(tile);
+			tile->setVisible(+1);
+			tile->setDiscovered(true, O_FLOOR);
+
+			// walls to the east or south of a visible tile, we see that too
+			Tile* t = _save->getTile(Position(posVisited.x + 1, posVisited.y, posVisited.z));
+			if (t) t->setDiscovered(true, O_WESTWALL);
+			t = _save->getTile(Position(posVisited.x, posVisited.y + 1, posVisited.z));
+			if (t) t->setDiscovered(true, O_NORTHWALL);
+		}
+	}
+}
+
+/**
+* Calculates line of sight of tiles for a player controlled soldier.
+* If supplied with an event position differing from the soldier's position, it will only
+* calculate tiles within a narrow arc.
+* @param unit Unit to check line of sight of.
+* @param eventPos The centre of the event which necessitated the FOV update. Used to optimize which tiles to update.
+* @param eventRadius The radius of a circle able to fully encompass the event, in tiles. Hence: 1 for a single tile event.
+*/
+void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius)
+{
+	FieldOfView fov;
+	findTilesInFOV(unit, eventPos, eventRadius, fov);
+	applyTilesInFOV(unit, fov);
+}
+
+/**
+* Calculates field of view of multiple units, using all worker threads when no unit has visibility script.
+* Each unit is calculated independently with only read access to the map, then
+* results are applied to units and tiles in order of `units`, this give
+* same result regardless of number of threads.
+* @param units Units to update.
+* @param eventPos The centre of the event which necessitated the FOV update.
+* @param eventRadius The radius of a circle able to fully encompass the event, in tiles.
+* @param updateTiles Should we update visible tiles too.
+* @param appendToTileVisibility When false, clears visible tiles of each unit before update.
+*/
+void TileEngine::calculateFOVParallel(const std::vector<BattleUnit*> &units, const Position eventPos, const int eventRadius, const bool updateTiles, const bool appendToTileVisibility)
+{
+	if (_fieldOfView.size() < units.size())
+	{
+		_fieldOfView.resize(units.size());
+	}
+
+	auto find = [&](size_t i, size_t)
+	{
+		if (updateTiles)
+		{
+			findTilesInFOV(units[i], eventPos, eventRadius, _fieldOfView[i]);
+		}
+		findUnitsInFOV(units[i], eventPos, eventRadius, _fieldOfView[i]);
+	};
+
+	// script engine is not thread safe (logging and error reporting), units with visibility scripts are calculated on main thread
+	bool haveScripts = false;
+	for (auto* unit : units)
+	{
+		if (unit->getArmor()->getScript<ModScript::VisibilityUnit>().hasAnyScript())
+		{
+			haveScripts = true;
+			break;
+		}
+	}
+	if (haveScripts)
+	{
+		for (size_t i = 0; i < units.size(); ++i)
+		{
+			find(i, 0);
+		}
+	}
+	else
+	{
+		ThreadPool::getShared().parallelFor(units.size(), find);
+	}
+
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		if (updateTiles)
+		{
+			if (!appendToTileVisibility)
+			{
+				units[i]->clearVisibleTiles();
+			}
+			applyTilesInFOV(units[i], _fieldOfView[i]);
+		}
+		applyUnitsInFOV(units[i], _fieldOfView[i]);
+	}
 }
 
 /**
@@ -1653,6 +1959,7 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 */
 bool TileEngine::calculateFOV(BattleUnit *unit, bool doTileRecalc, bool doUnitRecalc)
 {
+	BattleProfiler::Scope profile(BPS_FOV);
 	//Force a full FOV recheck for this unit.
 	if (doTileRecalc) calculateTilesInFOV(unit);
 	return doUnitRecalc ? calculateUnitsInFOV(unit) : false;
@@ -2383,6 +2690,7 @@ bool TileEngine::canTargetTile(Position *originVoxel, Tile *tile, int part, Posi
  */
 void TileEngine::calculateFOV(Position position, int eventRadius, const bool updateTiles, const bool appendToTileVisibility)
 {
+	BattleProfiler::Scope profile(BPS_FOV);
 	int updateRadius;
 	if (eventRadius == -1)
 	{
@@ -2395,24 +2703,17 @@ void TileEngine::calculateFOV(Position position, int eventRadius, const bool upd
 		updateRadius = getMaxViewDistance() + (eventRadius > 0 ? eventRadius : 0);
 		updateRadius *= updateRadius;
 	}
+	std::vector<BattleUnit*> units;
 	for (std::vector<BattleUnit*>::iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
 	{
 		const Position posUnit = (*i)->getPosition();
 
 		if (Position::distance2dSq(position, posUnit) <= updateRadius) //could this unit have observed the event?
 		{
-			if (updateTiles)
-			{
-				if (!appendToTileVisibility)
-				{
-					(*i)->clearVisibleTiles();
-				}
-				calculateTilesInFOV((*i), position, eventRadius);
-			}
-
-			calculateUnitsInFOV((*i), position, eventRadius);
+			units.push_back(*i);
 		}
 	}
+	calculateFOVParallel(units, position, eventRadius, updateTiles, appendToTileVisibility);
 }
 
 /**
@@ -2423,6 +2724,7 @@ void TileEngine::calculateFOV(Position position, int eventRadius, const bool upd
  */
 bool TileEngine::checkReactionFire(BattleUnit *unit, const BattleAction &originalAction)
 {
+	BattleProfiler::Scope profile(BPS_REACTION_FIRE);
 	if (_save->isPreview())
 	{
 		return false;
@@ -4408,10 +4710,11 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 	}
 	Position pos = voxel.toTile();
 	Tile *tile, *tileBelow;
-	if (_cacheTilePos == pos)
+	WorkerScratch &scratch = getWorkerScratch();
+	if (scratch.cacheTilePos == pos)
 	{
-		tile = _cacheTile;
-		tileBelow = _cacheTileBelow;
+		tile = scratch.cacheTile;
+		tileBelow = scratch.cacheTileBelow;
 	}
 	else
 	{
@@ -4421,9 +4724,9 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 			return V_OUTOFBOUNDS; //not even cache
 		}
 		tileBelow = _save->getBelowTile(tile);
-		_cacheTilePos = pos;
-		_cacheTile = tile;
-		_cacheTileBelow = tileBelow;
+		scratch.cacheTilePos = pos;
+		scratch.cacheTile = tile;
+		scratch.cacheTileBelow = tileBelow;
  	}
 
 	if (tile->isVoid() && tile->getUnit() == 0 && (!tileBelow || tileBelow->getUnit() == 0))
@@ -4431,29 +4734,33 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 		return V_EMPTY;
 	}
 
-	if (tile->getMapData(O_FLOOR) && tile->getMapData(O_FLOOR)->isGravLift() && (voxel.z % 24 == 0 || voxel.z % 24 == 1))
+	// first we check terrain voxel data, not to allow 2x2 units stick through walls
+	// cached bitmap tell us if we need look at tile parts at all
+	if (_save->isTerrainVoxel(_save->getTileIndex(pos), voxel))
 	{
-		if ((tile->getPosition().z == 0) || (tileBelow && tileBelow->getMapData(O_FLOOR) && !tileBelow->getMapData(O_FLOOR)->isGravLift()))
+		if (tile->getMapData(O_FLOOR) && tile->getMapData(O_FLOOR)->isGravLift() && (voxel.z % 24 == 0 || voxel.z % 24 == 1))
 		{
-			return V_FLOOR;
+			if ((tile->getPosition().z == 0) || (tileBelow && tileBelow->getMapData(O_FLOOR) && !tileBelow->getMapData(O_FLOOR)->isGravLift()))
+			{
+				return V_FLOOR;
+			}
 		}
-	}
 
-	// first we check terrain voxel data, not to allow 2x2 units stick through walls
-	for (int i = V_FLOOR; i <= V_OBJECT; ++i)
-	{
-		TilePart tp = (TilePart)i;
-		MapData *mp = tile->getMapData(tp);
-		if (((tp == O_WESTWALL) || (tp == O_NORTHWALL)) && tile->isUfoDoorOpen(tp))
-			continue;
-		if (mp != 0)
+		for (int i = V_FLOOR; i <= V_OBJECT; ++i)
 		{
-			int x = 15 - voxel.x%16;
-			int y = voxel.y%16;
-			int idx = (mp->getLoftID((voxel.z%24)/2)*16) + y;
-			if (_voxelData->at(idx) & (1 << x))
+			TilePart tp = (TilePart)i;
+			MapData *mp = tile->getMapData(tp);
+			if (((tp == O_WESTWALL) || (tp == O_NORTHWALL)) && tile->isUfoDoorOpen(tp))
+				continue;
+			if (mp != 0)
 			{
-				return (VoxelType)i;
+				int x = 15 - voxel.x%16;
+				int y = voxel.y%16;
+				int idx = (mp->getLoftID((voxel.z%24)/2)*16) + y;
+				if (_voxelData->at(idx) & (1 << x))
+				{
+					return (VoxelType)i;
+				}
 			}
 		}
 	}
@@ -4502,9 +4809,10 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 
 void TileEngine::voxelCheckFlush()
 {
-	_cacheTilePos = invalid;
-	_cacheTile = 0;
-	_cacheTileBelow = 0;
+	WorkerScratch &scratch = getWorkerScratch();
+	scratch.cacheTilePos = invalid;
+	scratch.cacheTile = 0;
+	scratch.cacheTileBelow = 0;
 }
 
 /**
@@ -5602,13 +5910,17 @@ bool TileEngine::validateThrow(BattleAction &action, Position originVoxel, Posit
  */
 void TileEngine::recalculateFOV()
 {
+	BattleProfiler::Scope profile(BPS_FOV);
+	std::vector<BattleUnit*> units;
 	for (std::vector<BattleUnit*>::iterator bu = _save->getUnits()->begin(); bu != _save->getUnits()->end(); ++bu)
 	{
 		if ((*bu)->getTile() != 0)
 		{
-			calculateFOV(*bu);
+			units.push_back(*bu);
 		}
 	}
+	// full recalculation clear old visible tiles by itself
+	calculateFOVParallel(units, invalid, 0, true, true);
 }
 
 /**
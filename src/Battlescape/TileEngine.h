@@ -18,6 +18,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <vector>
+#include <array>
 #include "Position.h"
 #include "BattlescapeGame.h"
 #include "../Mod/RuleItem.h"
@@ -85,6 +86,56 @@ private:
 		int count;
 	};
 
+	/**
+	 * Helper class storing data that each worker thread need own copy of.
+	 */
+	struct WorkerScratch
+	{
+		Tile *cacheTile = nullptr;
+		Tile *cacheTileBelow = nullptr;
+		Position cacheTilePos = invalid;
+		Position eventVisibilitySectorL, eventVisibilitySectorR, eventVisibilityObserverPos;
+		std::vector<Position> trajectory;
+		std::vector<Uint8> visitedTiles;
+	};
+
+	/**
+	 * Helper class storing FOV of one unit, calculated before it is applied to units and tiles.
+	 */
+	struct FieldOfView
+	{
+		/// Visible tiles are not calculated for this unit.
+		bool tilesSkip = true;
+		/// Clear all visible tiles before adding new ones.
+		bool tilesClear = false;
+		/// Tiles in order in which they were reached by line of sight.
+		std::vector<Tile*> tiles;
+		/// Visible units are not calculated for this unit.
+		bool unitsSkip = true;
+		/// Clear all visible units before adding new ones.
+		bool unitsClear = false;
+		/// Units in order of checks, with flag if unit is visible or should be removed from visible list.
+		std::vector<std::pair<BattleUnit*, bool>> units;
+	};
+
+	/**
+	 * Helper class storing light emitted by one unit, used to remove it without recalculating other units.
+	 */
+	struct UnitLight
+	{
+		/// Unit that emitted this light.
+		const BattleUnit *unit = nullptr;
+		/// Position of unit when light was calculated.
+		Position position = invalid;
+		/// Power of light, zero if unit do not emit any.
+		int power = 0;
+		/// Index and light level of each tile lit by unit.
+		std::vector<std::pair<int, Uint8>> tiles;
+	};
+
+	/// Number of unit light levels that are tracked, anything brighter is same as max light.
+	static constexpr int UnitLightLevels = 16;
+
 	SavedBattleGame *_save;
 	const std::vector<Uint16> *_voxelData;
 
@@ -94,13 +145,20 @@ private:
 	std::vector<Uint32> _lightPropagationTerrainBlocking;
 	/// Cache for marking tiles that need light updated.
 	std::vector<Uint32> _lightPropagationTempNeedUpdate;
+	/// Light of each unit, in same order as units in battle.
+	std::vector<UnitLight> _unitLights;
+	/// Number of units that lit each tile with each light level.
+	std::vector<std::array<Uint8, UnitLightLevels>> _unitLightCount;
+	/// Light of unit that is currently calculated.
+	std::vector<Uint8> _unitLightTemp;
 
 	const RuleInventory *_inventorySlotGround;
 	constexpr static int heightFromCenter[11] = {0,-2,+2,-4,+4,-6,+6,-8,+8,-12,+12};
 	bool _personalLighting;
-	Tile *_cacheTile;
-	Tile *_cacheTileBelow;
-	Position _cacheTilePos;
+	/// Data used by each worker of thread pool.
+	std::vector<WorkerScratch> _workerScratch;
+	/// Buffers for FOV calculated by `calculateFOVParallel`.
+	std::vector<FieldOfView> _fieldOfView;
 	const int _maxViewDistance;        // 20 tiles by default
 	const int _maxViewDistanceSq;      // 20 * 20
 	const int _maxVoxelViewDistance;   // maxViewDistance * 16
@@ -108,12 +166,17 @@ private:
 	const int _maxStaticLightDistance;
 	const int _maxDynamicLightDistance;
 	const int _enhancedLighting;
-	Position _eventVisibilitySectorL, _eventVisibilitySectorR, _eventVisibilityObserverPos;
 	std::vector<BattleUnit*> _movingUnitPrev;
 	BattleUnit* _movingUnit = nullptr;
 
 	/// Add light source.
-	void addLight(MapSubset gs, Position center, int power, LightLayers layer);
+	void addLight(MapSubset gs, Position center, int power, LightLayers layer, UnitLight *source = nullptr);
+	/// Gets power of light emitted by unit.
+	int getUnitLightPower(const BattleUnit *unit) const;
+	/// Adds light of unit to tiles.
+	void applyUnitLight(const UnitLight &light);
+	/// Removes light of unit from tiles.
+	void removeUnitLight(const UnitLight &light);
 	/// Calculate blockage amount.
 	int blockage(Tile *tile, const TilePart part, ItemDamageType type, int direction = -1, bool checkingFromOrigin = false);
 	/// Get max distance that fire light can reach.
@@ -131,8 +194,21 @@ private:
 	/// Get threshold of darkness for LoS calculation.
 	int getMaxDarknessToSeeUnits() const { return _maxDarknessToSeeUnits; }
 
+	/// Gets data dedicated for current worker thread.
+	WorkerScratch &getWorkerScratch();
 	bool setupEventVisibilitySector(const Position &observerPos, const Position &eventPos, const int &eventRadius);
-	inline bool inEventVisibilitySector(const Position &toCheck) const;
+	inline bool inEventVisibilitySector(const Position &toCheck);
+
+	/// Finds tiles within the field of view, without changing unit or tiles.
+	void findTilesInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius, FieldOfView &fov);
+	/// Updates visible tiles of unit from calculated field of view.
+	void applyTilesInFOV(BattleUnit *unit, const FieldOfView &fov);
+	/// Finds units within the field of view, without changing any unit.
+	void findUnitsInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius, FieldOfView &fov);
+	/// Updates visible units of unit from calculated field of view.
+	bool applyUnitsInFOV(BattleUnit *unit, const FieldOfView &fov);
+	/// Calculates field of view of multiple units using all worker threads.
+	void calculateFOVParallel(const std::vector<BattleUnit*> &units, const Position eventPos, const int eventRadius, const bool updateTiles, const bool appendToTileVisibility);
 
 	/// Calculates sun shading of the whole map.
 	void calculateSunShading(MapSubset gs);
@@ -141,7 +217,7 @@ private:
 	/// Recalculates lighting of the battlescape for terrain.
 	void calculateTerrainItems(MapSubset gs);
 	/// Recalculates lighting of the battlescape for units.
-	void calculateUnitLighting(MapSubset gs);
+	void calculateUnitLighting(MapSubset changedArea);
 
 	/// Checks validity of a snap shot to this position.
 	ReactionScore determineReactionType(BattleUnit *unit, BattleUnit *target);
@@ -79,6 +79,10 @@
 #include <cxxabi.h>
 #include <dlfcn.h>
 #include <dirent.h>
+#include <fcntl.h>
+#ifndef __MORPHOS__
+#include <sys/mman.h>
+#endif
 #include "Unicode.h"
 #endif		/* #ifdef _WIN32 */
 #include <SDL.h>
@@ -859,7 +863,8 @@ time_t getDateModified(const std::string &path)
 #ifdef _WIN32
 	time_t rv = 0;
 	auto pathW = pathToWindows(path);
-	auto fh = CreateFileW(pathW.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+	// backup semantics are needed to open directories
+	auto fh = CreateFileW(pathW.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
 	if (fh == INVALID_HANDLE_VALUE) {
 		return 0;
 	}
@@ -1035,6 +1040,77 @@ std::unique_ptr<std::istream> readFile(const std::string& filename) {
 	return std::unique_ptr<std::istream>(new std::istringstream(datastr));
 }
 
+/**
+ * Maps a file to memory for reading, pages are loaded by the system when accessed.
+ * @param filename - what to map
+ * @param size - size of the file
+ * @return pointer to the file data, or null if file can't be mapped (caller should read it normally)
+ */
+const void *mapFile(const std::string& filename, size_t &size) {
+	size = 0;
+#ifdef _WIN32
+	auto pathW = pathToWindows(filename);
+	HANDLE file = CreateFileW(pathW.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return nullptr;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 || (ULONGLONG)fileSize.QuadPart > (size_t)-1) {
+		CloseHandle(file);
+		return nullptr;
+	}
+	HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (mapping == NULL) {
+		return nullptr;
+	}
+	// view keeps the mapping alive
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (data == NULL) {
+		return nullptr;
+	}
+	size = (size_t)fileSize.QuadPart;
+	return data;
+#elif defined(__MORPHOS__) || defined(__ANDROID__)
+	return nullptr;
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return nullptr;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+		close(fd);
+		return nullptr;
+	}
+	void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return nullptr;
+	}
+	size = (size_t)info.st_size;
+	return data;
+#endif
+}
+
+/**
+ * Releases file mapped by mapFile().
+ * @param data - pointer returned by mapFile()
+ * @param size - size returned by mapFile()
+ */
+void unmapFile(const void *data, size_t size) {
+	if (!data) {
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#elif defined(__MORPHOS__) || defined(__ANDROID__)
+#else
+	munmap(const_cast<void*>(data), size);
+#endif
+}
+
 /**
  * Gets an istream to a file's bytes at least up to and including first "\n---" sequence.
  * To be used only for savegames.
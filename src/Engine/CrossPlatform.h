@@ -94,6 +94,10 @@ namespace CrossPlatform
 	bool writeFile(const std::string& filename, const std::vector<unsigned char>& data);
 	/// Reads in a file
 	std::unique_ptr<std::istream> readFile(const std::string& filename);
+	/// Maps a file to memory for reading.
+	const void *mapFile(const std::string& filename, size_t &size);
+	/// Releases a file mapped to memory.
+	void unmapFile(const void *data, size_t size);
 	/// Reads file until "\n---" sequence is met or to the end. To be used only for savegames.
 	std::unique_ptr<std::istream> getYamlSaveHeader (const std::string& filename);
 	/// Flashes the game window.
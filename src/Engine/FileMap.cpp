@@ -36,6 +36,8 @@
  * A. somename.zip is always scanned before somename/ directory.
  */
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <sstream>
 #include <istream>
@@ -48,6 +50,7 @@
 #include "CrossPlatform.h"
 #include "Options.h"
 #include "Exception.h"
+#include "StartupProfiler.h"
 
 #define MINIZ_NO_STDIO
 #include "../../libs/miniz/miniz.h"
@@ -162,12 +165,6 @@ static mz_bool mz_zip_reader_init_rwops(mz_zip_archive *pZip, SDL_RWops *rwops)
 	pZip->m_pIO_opaque = rwops;
 	return mz_zip_reader_init(pZip, size, 0);
 }
-static mz_bool mz_zip_reader_end_rwops(mz_zip_archive *pZip) {
-	if (!pZip) { return false; }
-	if (!pZip->m_pIO_opaque) { return false; }
-	SDL_RWclose((SDL_RWops *)(pZip->m_pIO_opaque));
-	return mz_zip_reader_end(pZip);
-}
 
 }
 
@@ -205,12 +202,291 @@ static inline std::string concatOptionalPaths(const std::string& basePath, const
 	}
 }
 
+/**
+ * Read only file content mapped to memory, shared by all views of it.
+ */
+struct MappedMemory
+{
+	const Uint8 *data;
+	size_t size;
+
+	MappedMemory(const void *d, size_t s) : data((const Uint8 *)d), size(s) { }
+	~MappedMemory() { CrossPlatform::unmapFile(data, size); }
+
+	/// Maps file, returns null if the file can't be mapped.
+	static std::shared_ptr<MappedMemory> map(const std::string& path) {
+		size_t size = 0;
+		const void *data = CrossPlatform::mapFile(path, size);
+		if (!data) { return nullptr; }
+		return std::make_shared<MappedMemory>(data, size);
+	}
+};
+
+/**
+ * Part of mapped memory accessed by RWops, keeps whole mapping alive.
+ */
+struct MemoryView
+{
+	std::shared_ptr<MappedMemory> owner;
+	const Uint8 *base;
+	size_t size;
+	size_t pos;
+};
+
+static int viewops_seek(SDL_RWops *context, int offset, int whence) {
+	auto view = (MemoryView *)context->hidden.unknown.data1;
+	Sint64 target;
+	switch (whence) {
+		case RW_SEEK_SET: target = offset; break;
+		case RW_SEEK_CUR: target = (Sint64)view->pos + offset; break;
+		case RW_SEEK_END: target = (Sint64)view->size + offset; break;
+		default: SDL_SetError("Unknown value for 'whence'"); return -1;
+	}
+	if (target < 0) { target = 0; }
+	if (target > (Sint64)view->size) { target = view->size; }
+	view->pos = (size_t)target;
+	return (int)view->pos;
+}
+static int viewops_read(SDL_RWops *context, void *ptr, int size, int maxnum) {
+	auto view = (MemoryView *)context->hidden.unknown.data1;
+	if (size <= 0 || maxnum <= 0) { return 0; }
+	size_t num = std::min((size_t)maxnum, (view->size - view->pos) / size);
+	memcpy(ptr, view->base + view->pos, num * size);
+	view->pos += num * size;
+	return (int)num;
+}
+static int viewops_write(SDL_RWops *context, const void *ptr, int size, int num) {
+	SDL_SetError("Can't write to a read only file");
+	return -1;
+}
+static int viewops_close(SDL_RWops *context) {
+	if (context) {
+		delete (MemoryView *)context->hidden.unknown.data1;
+		SDL_FreeRW(context);
+	}
+	return 0;
+}
+/**
+ * Creates RWops reading mapped memory directly, without any copy.
+ */
+static SDL_RWops *SDL_RWFromView(const std::shared_ptr<MappedMemory>& owner, const Uint8 *base, size_t size) {
+	SDL_RWops *rv = SDL_AllocRW();
+	if (!rv) { return NULL; }
+	rv->seek = viewops_seek;
+	rv->read = viewops_read;
+	rv->write = viewops_write;
+	rv->close = viewops_close;
+	rv->hidden.unknown.data1 = new MemoryView{ owner, base, size, 0 };
+	return rv;
+}
+/**
+ * Gets view of mapped memory used by RWops, or null if it's other kind of RWops.
+ */
+static const MemoryView *getRWopsView(SDL_RWops *rwops) {
+	return (rwops && rwops->close == viewops_close) ? (const MemoryView *)rwops->hidden.unknown.data1 : NULL;
+}
+/**
+ * Opens whole file as view of mapped memory, or normally if it can't be mapped.
+ */
+static SDL_RWops *SDL_RWFromMappedFile(const std::string& path) {
+	auto mapped = MappedMemory::map(path);
+	if (mapped) {
+		return SDL_RWFromView(mapped, mapped->data, mapped->size);
+	}
+	return SDL_RWFromFile(path.c_str(), "rb");
+}
+
+/**
+ * Stream buffer reading mapped memory directly, without any copy.
+ */
+class MemoryViewBuf : public std::streambuf
+{
+	std::shared_ptr<MappedMemory> _owner;
+public:
+	MemoryViewBuf(const std::shared_ptr<MappedMemory>& owner, const Uint8 *base, size_t size) : _owner(owner) {
+		char *b = (char *)base;
+		setg(b, b, b + size);
+	}
+protected:
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+		off_type target;
+		if (dir == std::ios_base::beg) { target = off; }
+		else if (dir == std::ios_base::cur) { target = (gptr() - eback()) + off; }
+		else { target = (egptr() - eback()) + off; }
+		if (target < 0 || target > egptr() - eback()) { return pos_type(off_type(-1)); }
+		setg(eback(), eback() + target, egptr());
+		return pos_type(target);
+	}
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+		return seekoff(off_type(pos), std::ios_base::beg, which);
+	}
+};
+/**
+ * Input stream reading mapped memory directly, without any copy.
+ */
+class MemoryViewStream : public std::istream
+{
+	MemoryViewBuf _buf;
+public:
+	MemoryViewStream(const std::shared_ptr<MappedMemory>& owner, const Uint8 *base, size_t size) : std::istream(nullptr), _buf(owner, base, size) {
+		rdbuf(&_buf);
+	}
+};
+
+/**
+ * Zip archive with its data source.
+ * `FileRecord::zip` points to this, `mz_zip_archive` need to be first.
+ */
+struct ZipContext
+{
+	mz_zip_archive zip;
+	SDL_RWops *rwops;
+	/// Set when whole archive is mapped to memory.
+	const MemoryView *view;
+};
+
+/**
+ * Finds raw data of an entry in mapped zip.
+ * @return True if entry can be read directly from mapped memory.
+ */
+static bool getZipEntryData(void *zip, size_t findex, mz_zip_archive_file_stat &fistat, const Uint8 *&data) {
+	auto ctx = (ZipContext *)zip;
+	if (!ctx->view) { return false; }
+	if (!mz_zip_reader_file_stat(&ctx->zip, (mz_uint)findex, &fistat)) { return false; }
+	if (fistat.m_is_encrypted || !fistat.m_is_supported) { return false; }
+	if (fistat.m_method == 0 && fistat.m_comp_size != fistat.m_uncomp_size) { return false; }
+
+	// local header: signature, ..., name length at 26, extra length at 28, data at 30 + name + extra
+	const Uint8 *begin = ctx->view->base;
+	const Uint8 *end = begin + ctx->view->size;
+	if (fistat.m_local_header_ofs + 30 > ctx->view->size) { return false; }
+	const Uint8 *header = begin + fistat.m_local_header_ofs;
+	if (header[0] != 0x50 || header[1] != 0x4b || header[2] != 0x03 || header[3] != 0x04) { return false; }
+	size_t nameLen = header[26] | (header[27] << 8);
+	size_t extraLen = header[28] | (header[29] << 8);
+	const Uint8 *start = header + 30 + nameLen + extraLen;
+	if (start > end || (size_t)(end - start) < fistat.m_comp_size) { return false; }
+	data = start;
+	return true;
+}
+
+/**
+ * Deflated zip entry decompressed while it is read, straight from mapped memory.
+ * Don't use archive state, so it is independent of `FileMap::clear()` and other threads.
+ */
+struct ZipStream
+{
+	std::shared_ptr<MappedMemory> owner;
+	const Uint8 *comp;
+	size_t compSize;
+	size_t compPos;
+	tinfl_decompressor inflator;
+	tinfl_status status;
+	std::vector<Uint8> dict;
+	size_t dictOfs;
+	size_t dictAvail;
+	size_t size;
+	size_t pos;
+
+	/// Starts decompression from beginning.
+	void restart() {
+		tinfl_init(&inflator);
+		status = TINFL_STATUS_NEEDS_MORE_INPUT;
+		compPos = 0;
+		dictOfs = 0;
+		dictAvail = 0;
+		pos = 0;
+	}
+	/// Decompress next bytes, output can be null to skip them.
+	size_t read(Uint8 *out, size_t n) {
+		size_t done = 0;
+		while (done < n) {
+			if (dictAvail > 0) {
+				size_t chunk = std::min(n - done, dictAvail);
+				if (out) { memcpy(out + done, dict.data() + dictOfs, chunk); }
+				dictOfs = (dictOfs + chunk) & (TINFL_LZ_DICT_SIZE - 1);
+				dictAvail -= chunk;
+				done += chunk;
+				pos += chunk;
+				continue;
+			}
+			if (status != TINFL_STATUS_NEEDS_MORE_INPUT && status != TINFL_STATUS_HAS_MORE_OUTPUT) { break; }
+			size_t inBytes = compSize - compPos;
+			size_t outBytes = TINFL_LZ_DICT_SIZE - dictOfs;
+			status = tinfl_decompress(&inflator, comp + compPos, &inBytes, dict.data(), dict.data() + dictOfs, &outBytes, 0);
+			compPos += inBytes;
+			dictAvail = outBytes;
+			if (outBytes == 0) { break; }
+		}
+		return done;
+	}
+};
+
+static int zipstreamops_read(SDL_RWops *context, void *ptr, int size, int maxnum) {
+	auto stream = (ZipStream *)context->hidden.unknown.data1;
+	if (size <= 0 || maxnum <= 0) { return 0; }
+	size_t num = std::min((size_t)maxnum, (stream->size - stream->pos) / size);
+	size_t read = stream->read((Uint8 *)ptr, num * size);
+	return (int)(read / size);
+}
+static int zipstreamops_seek(SDL_RWops *context, int offset, int whence) {
+	auto stream = (ZipStream *)context->hidden.unknown.data1;
+	Sint64 target;
+	switch (whence) {
+		case RW_SEEK_SET: target = offset; break;
+		case RW_SEEK_CUR: target = (Sint64)stream->pos + offset; break;
+		case RW_SEEK_END: target = (Sint64)stream->size + offset; break;
+		default: SDL_SetError("Unknown value for 'whence'"); return -1;
+	}
+	if (target < 0) { target = 0; }
+	if (target > (Sint64)stream->size) { target = stream->size; }
+	if ((size_t)target < stream->pos) {
+		// deflate can't go back, start again
+		stream->restart();
+	}
+	stream->read(NULL, (size_t)target - stream->pos);
+	return (int)stream->pos;
+}
+static int zipstreamops_close(SDL_RWops *context) {
+	if (context) {
+		delete (ZipStream *)context->hidden.unknown.data1;
+		SDL_FreeRW(context);
+	}
+	return 0;
+}
+/**
+ * Creates RWops that decompress deflated zip entry from mapped memory while it is read.
+ */
+static SDL_RWops *SDL_RWFromZipStream(const std::shared_ptr<MappedMemory>& owner, const Uint8 *comp, const mz_zip_archive_file_stat &fistat) {
+	SDL_RWops *rv = SDL_AllocRW();
+	if (!rv) { return NULL; }
+	auto stream = new ZipStream();
+	stream->owner = owner;
+	stream->comp = comp;
+	stream->compSize = (size_t)fistat.m_comp_size;
+	stream->dict.resize(TINFL_LZ_DICT_SIZE);
+	stream->size = (size_t)fistat.m_uncomp_size;
+	stream->restart();
+	rv->seek = zipstreamops_seek;
+	rv->read = zipstreamops_read;
+	rv->write = viewops_write;
+	rv->close = zipstreamops_close;
+	rv->hidden.unknown.data1 = stream;
+	return rv;
+}
+
 FileRecord::FileRecord() : fullpath(""), zip(NULL), findex(0) { }
 
 SDL_RWops *FileRecord::getRWops() const
 {
 	SDL_RWops *rv;
-	if (zip != NULL) {
+	mz_zip_archive_file_stat fistat;
+	const Uint8 *viewData;
+	if (zip != NULL && getZipEntryData(zip, findex, fistat, viewData) && fistat.m_method == 0) {
+		rv = SDL_RWFromView(((ZipContext *)zip)->view->owner, viewData, (size_t)fistat.m_uncomp_size);
+	} else if (zip != NULL && getZipEntryData(zip, findex, fistat, viewData) && fistat.m_method == MZ_DEFLATED) {
+		rv = SDL_RWFromZipStream(((ZipContext *)zip)->view->owner, viewData, fistat);
+	} else if (zip != NULL) {
 		rv = SDL_RWFromMZ((mz_zip_archive *)zip, findex);
 	} else {
 		rv = SDL_RWFromFile(fullpath.c_str(), "rb");
@@ -222,10 +498,20 @@ SDL_RWops *FileRecord::getRWops() const
 SDL_RWops *FileRecord::getRWopsReadAll() const
 {
 	SDL_RWops *rv;
-	if (zip != NULL)
+	mz_zip_archive_file_stat fistat;
+	const Uint8 *viewData;
+	if (zip != NULL && getZipEntryData(zip, findex, fistat, viewData) && fistat.m_method == 0)
+	{
+		rv = SDL_RWFromView(((ZipContext *)zip)->view->owner, viewData, (size_t)fistat.m_uncomp_size);
+	}
+	else if (zip != NULL)
 	{
 		rv = SDL_RWFromMZ((mz_zip_archive *)zip, findex);
 	}
+	else if (auto mapped = MappedMemory::map(fullpath))
+	{
+		rv = SDL_RWFromView(mapped, mapped->data, mapped->size);
+	}
 	else
 	{
 		rv = SDL_RWFromFile(fullpath.c_str(), "rb");
@@ -264,7 +550,11 @@ SDL_RWops *FileRecord::getRWopsReadAll() const
 
 std::unique_ptr<std::istream> FileRecord::getIStream() const
 {
-	if (zip != NULL) {
+	mz_zip_archive_file_stat fistat;
+	const Uint8 *viewData;
+	if (zip != NULL && getZipEntryData(zip, findex, fistat, viewData) && fistat.m_method == 0) {
+		return std::unique_ptr<std::istream>(new MemoryViewStream(((ZipContext *)zip)->view->owner, viewData, (size_t)fistat.m_uncomp_size));
+	} else if (zip != NULL) {
 		size_t size;
 		void *data = mz_zip_reader_extract_to_heap((mz_zip_archive *)zip, findex, &size, 0);
 		if (data == NULL) {
@@ -277,6 +567,8 @@ std::unique_ptr<std::istream> FileRecord::getIStream() const
 		auto rv = new std::stringstream(a_string);
 		mz_free(data);
 		return std::unique_ptr<std::istream>(rv);
+	} else if (auto mapped = MappedMemory::map(fullpath)) {
+		return std::unique_ptr<std::istream>(new MemoryViewStream(mapped, mapped->data, mapped->size));
 	} else {
 		return CrossPlatform::readFile(fullpath);
 	}
@@ -329,8 +621,10 @@ static std::string hexDumpBogusData(const std::string& bogus) {
 }
 /* recursively list a directory */
 typedef std::vector<std::pair<std::string, std::string>> dirlist_t; // <dirname, basename>
-static bool ls_r(const std::string &basePath, const std::string &relPath, dirlist_t& dlist) {
+typedef std::vector<std::pair<std::string, time_t>> dirtimes_t; // <dirname, mtime>
+static bool ls_r(const std::string &basePath, const std::string &relPath, dirlist_t& dlist, dirtimes_t *dtimes = NULL) {
 	auto fullDir = concatOptionalPaths(basePath, relPath);
+	if (dtimes) { dtimes->push_back(std::make_pair(relPath, CrossPlatform::getDateModified(fullDir))); }
 	auto files = CrossPlatform::getFolderContents(fullDir);
 	//Log(LOG_VERBOSE) << "ls_r: listing "<<fullDir<<" count="<<files.size();
 	for (auto i = files.begin(); i != files.end(); ++i) {
@@ -338,7 +632,7 @@ static bool ls_r(const std::string &basePath, const std::string &relPath, dirlis
 			auto fullpath = concatPaths(fullDir, std::get<0>(*i));
 			if (CrossPlatform::folderExists(fullpath)) {
 				auto nextRelPath = concatOptionalPaths(relPath, std::get<0>(*i));
-				ls_r(basePath, nextRelPath, dlist);
+				ls_r(basePath, nextRelPath, dlist, dtimes);
 				continue;
 			}
 		} else {
@@ -347,6 +641,110 @@ static bool ls_r(const std::string &basePath, const std::string &relPath, dirlis
 	}
 	return true;
 }
+
+/**
+ * Listing of a plain directory tree, kept in the index file between runs.
+ * It stays valid while modification times of all its directories are the same,
+ * as adding, removing or renaming a file changes time of the directory that contains it.
+ */
+struct DirIndexEntry {
+	dirtimes_t dirs;
+	dirlist_t files;
+};
+static const std::string DirIndexHeader = "OXCE vfs index 1";
+static std::unordered_map<std::string, DirIndexEntry> DirIndex;		// entries read from the index file
+static std::unordered_map<std::string, DirIndexEntry> DirIndexUsed;	// entries used in this run, only these are saved
+static bool DirIndexLoaded = false;
+static bool DirIndexChanged = false;
+
+/* reads the index file, anything wrong with it just means rescanning everything */
+static void loadDirIndex() {
+	DirIndexLoaded = true;
+	DirIndex.clear();
+	std::string path = Options::getUserFolder() + "vfs.index";
+	if (!CrossPlatform::fileExists(path)) {
+		DirIndexChanged = true;
+		return;
+	}
+	std::unique_ptr<std::istream> in;
+	try {
+		in = CrossPlatform::readFile(path);
+	} catch (Exception &) {
+		DirIndexChanged = true;
+		return;
+	}
+	std::string line;
+	if (!std::getline(*in, line) || line != DirIndexHeader) {
+		Log(LOG_INFO) << "VFS index ignored: version changed";
+		DirIndexChanged = true;
+		return;
+	}
+	DirIndexEntry *curr = NULL;
+	while (std::getline(*in, line)) {
+		bool ok = line.size() >= 2 && line[1] == '\t';
+		auto rest = ok ? line.substr(2) : std::string();
+		auto tab = rest.find('\t');
+		if (ok && line[0] == 'R') {
+			curr = &DirIndex[rest];
+		} else if (ok && line[0] == 'D' && curr && tab != rest.npos) {
+			curr->dirs.push_back(std::make_pair(rest.substr(tab + 1), (time_t)strtoll(rest.c_str(), NULL, 10)));
+		} else if (ok && line[0] == 'F' && curr && tab != rest.npos) {
+			curr->files.push_back(std::make_pair(rest.substr(0, tab), rest.substr(tab + 1)));
+		} else {
+			Log(LOG_INFO) << "VFS index ignored: broken file";
+			DirIndex.clear();
+			DirIndexChanged = true;
+			return;
+		}
+	}
+	Log(LOG_VERBOSE) << "VFS index: " << DirIndex.size() << " directories loaded";
+}
+/* checks that no directory of the tree changed since it was listed */
+static bool isDirIndexValid(const std::string &basePath, const DirIndexEntry &entry) {
+	if (entry.dirs.empty()) { return false; }
+	for (auto& d : entry.dirs) {
+		if (CrossPlatform::getDateModified(concatOptionalPaths(basePath, d.first)) != d.second) { return false; }
+	}
+	return true;
+}
+/* checks that listing can be stored and safely checked next time */
+static bool canDirIndex(const DirIndexEntry &entry) {
+	// changes in the same second as the listing would not be noticed
+	time_t recent = time(NULL) - 2;
+	for (auto& d : entry.dirs) {
+		if (d.second == 0 || d.second >= recent) { return false; }
+		if (d.first.find_first_of("\t\r\n") != d.first.npos) { return false; }
+	}
+	for (auto& f : entry.files) {
+		if (f.second.find_first_of("\t\r\n") != f.second.npos) { return false; }
+	}
+	return true;
+}
+/* recursively list a directory, reusing the listing from the index if nothing changed */
+static bool ls_indexed(const std::string &basePath, dirlist_t& dlist) {
+	if (!Options::oxceVFSIndex) {
+		return ls_r(basePath, "", dlist);
+	}
+	if (!DirIndexLoaded) { loadDirIndex(); }
+	auto it = DirIndex.find(basePath);
+	if (it != DirIndex.end() && isDirIndexValid(basePath, it->second)) {
+		dlist = it->second.files;
+		DirIndexUsed[basePath] = it->second;
+		return true;
+	}
+	DirIndexEntry entry;
+	if (!ls_r(basePath, "", entry.files, &entry.dirs)) {
+		return false;
+	}
+	dlist = entry.files;
+	if (canDirIndex(entry)) {
+		DirIndexUsed[basePath] = std::move(entry);
+	} else {
+		DirIndexUsed.erase(basePath);
+	}
+	DirIndexChanged = true;
+	return true;
+}
 static bool isRuleset(const std::string& fname) {
 	if (fname.size() < 4) { return false; }
 	auto last4 = fname.substr(fname.size() - 4);
@@ -418,7 +816,7 @@ struct VFSLayer {
 	*/
 	bool mapZipFile(const std::string& zippath, const std::string& prefix, bool ignore_ruls = false) {
 		std::string log_ctx = "mapZipFile(" + zippath + ",  '" + prefix + "',  '" + (ignore_ruls ? "true" : "false") + "'): ";
-		SDL_RWops *rwops = SDL_RWFromFile(zippath.c_str(), "r");
+		SDL_RWops *rwops = SDL_RWFromMappedFile(zippath);
 		if (!rwops) {
 			Log(LOG_WARNING) << log_ctx << "Ignoring zip '" << zippath << "': " << SDL_GetError();
 			return false;
@@ -502,7 +900,7 @@ struct VFSLayer {
 			throw Exception(err);
 		}
 		dirlist_t dlist;
-		if (!ls_r(dirpath, "", dlist)) {
+		if (!ls_indexed(dirpath, dlist)) {
 			return false;
 		}
 		fullpath = dirpath;
@@ -683,26 +1081,37 @@ struct VFS {
 static std::unordered_map<std::string, ModRecord *> ModsAvailable;
 static std::unordered_set<VFSLayer *> MappedVFSLayers; // owned here so we can have some sense of their lifetime
 												       // only the layers that get dropped on FileMap::clear()
-static std::vector<mz_zip_archive *> ZipContexts;	   // zip decompression contexts shared between layers that came from
+static std::vector<ZipContext *> ZipContexts;	   	   // zip decompression contexts shared between layers that came from
 													   // the same .zip. this makes the whole thing very thread-unsafe
 static VFS TheVFS;
 
 const RSOrder &getRulesets() { return TheVFS.get_rulesets(); }
 
 static mz_zip_archive *newZipContext(const std::string& log_ctx, SDL_RWops *rwops) {
-	mz_zip_archive *zip = (mz_zip_archive *) SDL_malloc(sizeof(mz_zip_archive));
-	if (!zip) {
+	ZipContext *ctx = (ZipContext *) SDL_malloc(sizeof(ZipContext));
+	if (!ctx) {
 		Log(LOG_FATAL) << log_ctx << ": " << SDL_GetError();
 		throw Exception("Out of memory");
 	}
-	if (!mz_zip_reader_init_rwops(zip, rwops)) {
+	ctx->rwops = rwops;
+	ctx->view = getRWopsView(rwops);
+	mz_zip_archive *zip = &ctx->zip;
+	bool ok;
+	if (ctx->view) {
+		// whole archive is in memory, miniz can read it directly
+		mz_zip_zero_struct(zip);
+		ok = mz_zip_reader_init_mem(zip, ctx->view->base, ctx->view->size, 0);
+	} else {
+		ok = mz_zip_reader_init_rwops(zip, rwops);
+	}
+	if (!ok) {
 		// whoa, no opening the file
 		Log(LOG_WARNING) << log_ctx << "Ignoring zip: " << mz_zip_get_error_string(mz_zip_get_last_error(zip));
 		SDL_RWclose(rwops);
-		SDL_free(zip);
+		SDL_free(ctx);
 		return NULL;
 	}
-	ZipContexts.push_back(zip);
+	ZipContexts.push_back(ctx);
 	return zip;
 }
 
@@ -712,7 +1121,7 @@ void clear(bool clearOnly, bool embeddedOnly) {
 	ModsAvailable.clear();
 	for (auto i : MappedVFSLayers ) { delete i; }
 	MappedVFSLayers.clear();
-	for (auto i : ZipContexts) { mz_zip_reader_end_rwops(i); SDL_free(i); }
+	for (auto i : ZipContexts) { mz_zip_reader_end(&i->zip); SDL_RWclose(i->rwops); SDL_free(i); }
 	ZipContexts.clear();
 	if (!clearOnly)
 	{
@@ -733,6 +1142,7 @@ void clear(bool clearOnly, bool embeddedOnly) {
 */
 void setup(const std::vector<const ModInfo* >& active, bool embeddedOnly)
 {
+	StartupProfiler::Scope profile("phase", "FileMap::setup");
 	TheVFS.clear();
 	TheVFS.map_common(embeddedOnly);
 	std::string log_ctx = "FileMap::setup(): ";
@@ -768,6 +1178,30 @@ void setup(const std::vector<const ModInfo* >& active, bool embeddedOnly)
 		TheVFS.dump(Logger().get(LOG_VERBOSE), "\n" + log_ctx, Options::oxceListVFSContents);
 	}
 }
+/**
+ * Writes listings of directories used in this run to the index file, if anything changed.
+ */
+void saveIndex()
+{
+	if (!Options::oxceVFSIndex || !DirIndexLoaded) { return; }
+	if (!DirIndexChanged && DirIndexUsed.size() == DirIndex.size()) { return; }
+	std::ostringstream out;
+	out << DirIndexHeader << "\n";
+	for (auto& i : DirIndexUsed) {
+		out << "R\t" << i.first << "\n";
+		for (auto& d : i.second.dirs) {
+			out << "D\t" << (long long)d.second << "\t" << d.first << "\n";
+		}
+		for (auto& f : i.second.files) {
+			out << "F\t" << f.first << "\t" << f.second << "\n";
+		}
+	}
+	if (CrossPlatform::writeFile(Options::getUserFolder() + "vfs.index", out.str())) {
+		Log(LOG_VERBOSE) << "VFS index: " << DirIndexUsed.size() << " directories saved";
+	}
+	DirIndex = DirIndexUsed;
+	DirIndexChanged = false;
+}
 [[gnu::unused]]
 static void dump_mods_layers(std::ostream &out, const std::string& prefix, bool verbose) {
 	out << prefix << ModsAvailable.size() << " mods mapped:";
@@ -935,7 +1369,7 @@ void scanModZipRW(SDL_RWops *rwops, const std::string& fullpath) {
  */
 void scanModZip(const std::string& fullpath) {
 	std::string log_ctx = "scanModZip(" + fullpath + "): ";
-	SDL_RWops *rwops = SDL_RWFromFile(fullpath.c_str(), "r");
+	SDL_RWops *rwops = SDL_RWFromMappedFile(fullpath);
 	if (!rwops) {
 		Log(LOG_WARNING) << log_ctx << "Ignoring zip: " << SDL_GetError();
 		return;
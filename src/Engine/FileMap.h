@@ -117,6 +117,9 @@ namespace FileMap
 	/// or participate in dependency loops
 	void checkModsDependencies();
 
+	/// saves listings of mapped directories, so unchanged ones are not scanned again next time.
+	void saveIndex();
+
 	/// returns a list of mods that are loadable.
 	std::map<std::string, ModInfo> getModInfos();
 
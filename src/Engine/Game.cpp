@@ -31,6 +31,7 @@
 #include "../Interface/Cursor.h"
 #include "../Interface/FpsCounter.h"
 #include "../Mod/Mod.h"
+#include "../Mod/SpriteResidency.h"
 #include "../Savegame/SavedGame.h"
 #include "../Savegame/SavedBattleGame.h"
 #include "Action.h"
@@ -38,10 +39,12 @@
 #include "Options.h"
 #include "CrossPlatform.h"
 #include "FileMap.h"
+#include "StartupProfiler.h"
 #include "Unicode.h"
 #include "../Ufopaedia/UfopaediaStartState.h"
 #include "../Menu/NotesState.h"
 #include "../Menu/TestState.h"
+#include "../Menu/SpriteMemoryState.h"
 #include <algorithm>
 #include "../fallthrough.h"
 
@@ -55,7 +58,7 @@ const double Game::VOLUME_GRADIENT = 10.0;
  * creates the display screen and sets up the cursor.
  * @param title Title of the game window.
  */
-Game::Game(const std::string &title) : _screen(0), _cursor(0), _lang(0), _save(0), _mod(0), _quit(false), _init(false), _update(false),  _mouseActive(true), _timeUntilNextFrame(0),
+Game::Game(const std::string &title) : _screen(0), _cursor(0), _lang(0), _save(0), _mod(0), _quit(false), _init(false), _update(false),  _mouseActive(true), _timeUntilNextFrame(0), _statesReset(false), _spriteDepth(0), _spriteLowDepth(0),
 	_ctrl(false), _alt(false), _shift(false), _rmb(false), _mmb(false)
 {
 	Options::reload = false;
@@ -158,6 +161,17 @@ void Game::run()
 			_deleted.pop_back();
 		}
 
+		// Unload sprites that only closed states could use
+		if (_mod && (_statesReset || _spriteLowDepth < _spriteDepth))
+		{
+			_mod->trimSprites(_states.size(), _spriteLowDepth, _statesReset);
+		}
+		_statesReset = false;
+		_spriteDepth = _states.size();
+		_spriteLowDepth = _states.size();
+		SpriteResidency::beginCycle();
+		SpriteResidency::setActiveDepth(_states.size());
+
 		// Initialize active state
 		if (!_init)
 		{
@@ -314,6 +328,11 @@ void Game::run()
 								Options::debugUi = !Options::debugUi;
 								_states.back()->redrawText();
 							}
+							// "ctrl-y" sprite memory
+							else if (action.getDetails()->key.keysym.sym == SDLK_y && isCtrlPressed() && _mod)
+							{
+								pushState(new SpriteMemoryState);
+							}
 						}
 					}
 					_states.back()->handle(&action);
@@ -331,6 +350,7 @@ void Game::run()
 		if (runningState != PAUSED)
 		{
 			// Process logic
+			SpriteResidency::setActiveDepth(_states.size());
 			_states.back()->think();
 			_fpsCounter->think();
 			if (Options::FPS > 0 && !(Options::useOpenGL && Options::vSyncForOpenGL))
@@ -360,8 +380,10 @@ void Game::run()
 
 				for (; i != _states.end(); ++i)
 				{
+					SpriteResidency::setActiveDepth(std::distance(_states.begin(), i) + 1);
 					(*i)->blit();
 				}
+				SpriteResidency::setActiveDepth(_states.size());
 				_fpsCounter->blit(_screen->getSurface());
 				_cursor->blit(_screen->getSurface());
 				_screen->flip();
@@ -456,6 +478,7 @@ void Game::setState(State *state)
 	}
 	pushState(state);
 	_init = false;
+	_statesReset = true;
 }
 
 /**
@@ -479,6 +502,7 @@ void Game::popState()
 {
 	_deleted.push_back(_states.back());
 	_states.pop_back();
+	_spriteLowDepth = std::min(_spriteLowDepth, _states.size());
 	_init = false;
 }
 
@@ -574,6 +598,7 @@ bool Game::isQuitting() const
  */
 void Game::loadLanguages()
 {
+	StartupProfiler::Scope profile("phase", "loadLanguages");
 	const std::string defaultLang = "en-US";
 	std::string currentLang = defaultLang;
 
@@ -55,6 +55,8 @@ private:
 	bool _mouseActive;
 	unsigned int _timeOfLastFrame;
 	int _timeUntilNextFrame;
+	bool _statesReset;
+	size_t _spriteDepth, _spriteLowDepth;
 	bool _ctrl, _alt, _shift, _rmb, _mmb;
 	static const double VOLUME_GRADIENT;
 
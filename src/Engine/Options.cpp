@@ -33,6 +33,7 @@
 #include "CrossPlatform.h"
 #include "../Menu/ModConfirmExtendedState.h"
 #include "FileMap.h"
+#include "StartupProfiler.h"
 #include "Screen.h"
 
 namespace OpenXcom
@@ -253,6 +254,17 @@ void create()
 	_info.push_back(OptionInfo("oxceListVFSContents", &oxceListVFSContents, false));
 	_info.push_back(OptionInfo("oxceRawScreenShots", &oxceRawScreenShots, false));
 	_info.push_back(OptionInfo("oxceThumbButtons", &oxceThumbButtons, true));
+	_info.push_back(OptionInfo("oxceWorkerThreads", &oxceWorkerThreads, 0));
+	_info.push_back(OptionInfo("oxceHierarchicalPathfinding", &oxceHierarchicalPathfinding, false));
+	_info.push_back(OptionInfo("oxceReadableBattleSave", &oxceReadableBattleSave, false));
+	_info.push_back(OptionInfo("oxceBattleProfiler", &oxceBattleProfiler, false));
+	_info.push_back(OptionInfo("oxceRulesetCache", &oxceRulesetCache, true));
+	_info.push_back(OptionInfo("oxceScriptCache", &oxceScriptCache, true));
+	_info.push_back(OptionInfo("oxceScriptThreadedDispatch", &oxceScriptThreadedDispatch, true));
+	_info.push_back(OptionInfo("oxceVFSIndex", &oxceVFSIndex, true));
+	_info.push_back(OptionInfo("oxceSpriteMemoryBudget", &oxceSpriteMemoryBudget, 0));
+	_info.push_back(OptionInfo("oxceGeoFastForward", &oxceGeoFastForward, false));
+	_info.push_back(OptionInfo("oxceStartupProfiler", &oxceStartupProfiler, false));
 
 	_info.push_back(OptionInfo("oxceRecommendedOptionsWereSet", &oxceRecommendedOptionsWereSet, false));
 	_info.push_back(OptionInfo("password", &password, "secret"));
@@ -672,6 +684,7 @@ bool init()
 // called from the dos screen state (StartState)
 void refreshMods()
 {
+	StartupProfiler::Scope profile("phase", "refreshMods");
 	if (Options::reload)
 	{
 		_masterMod = "";
@@ -706,6 +719,7 @@ void refreshMods()
 	// Check mods' dependencies on other mods and extResources (UFO, TFTD, etc),
 	// also breaks circular dependency loops.
 	FileMap::checkModsDependencies();
+	FileMap::saveIndex();
 
 	// Now we can get the list of ModInfos from the FileMap -
 	// those are the mods that can possibly be loaded.
@@ -840,6 +854,7 @@ void refreshMods()
 
 void updateMods()
 {
+	StartupProfiler::Scope profile("phase", "updateMods");
 	// pick up stuff in common before-hand
 	FileMap::clear(false, Options::oxceEmbeddedOnly);
 
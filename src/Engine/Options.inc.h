@@ -105,6 +105,55 @@ OPT bool oxceEmbeddedOnly;
 OPT bool oxceListVFSContents;
 OPT bool oxceRawScreenShots;
 OPT bool oxceThumbButtons;
+/**
+ * Number of threads used for heavy calculations.
+ * 0 = one for each CPU core, 1 = everything on main thread.
+ */
+OPT int oxceWorkerThreads;
+/**
+ * Use graph of map blocks to speed up long AI paths on big maps.
+ * Paths found this way can be longer than ones from full search.
+ */
+OPT bool oxceHierarchicalPathfinding;
+/**
+ * Save battle map nodes as readable YAML instead of binary data, for debugging.
+ * Loading a save and saving it again with this option converts it to readable form.
+ */
+OPT bool oxceReadableBattleSave;
+/**
+ * Log time spent in pathfinding, FOV, reaction fire and AI after each turn of battle.
+ */
+OPT bool oxceBattleProfiler;
+/**
+ * Keep parsed ruleset files in cache file in user folder, only new or changed files are parsed at startup.
+ * Errors in cached files are reported without line numbers, disable it when debugging a mod.
+ */
+OPT bool oxceRulesetCache;
+/**
+ * Keep compiled mod scripts in cache file in user folder, unchanged scripts are not parsed again at startup.
+ */
+OPT bool oxceScriptCache;
+/**
+ * Run scripts with threaded dispatch (each operation jumps directly to next one), where compiler supports it.
+ */
+OPT bool oxceScriptThreadedDispatch;
+/**
+ * Keep listings of mod and resource folders in index file in user folder, unchanged folders are not scanned again at startup.
+ */
+OPT bool oxceVFSIndex;
+/**
+ * Memory budget in MB for sprites loaded from mods with lazy loading, 0 means unlimited.
+ * Sprites not used by any open screen are unloaded when over budget, and loaded again when needed.
+ */
+OPT int oxceSpriteMemoryBudget;
+/**
+ * At 1 day speed, keep simulating more days in one tick of the geoscape clock, until the clock tick is used up or something needs the player.
+ */
+OPT bool oxceGeoFastForward;
+/**
+ * Record timings of startup and mod loading, written as trace file "startup-profile.json" to user folder.
+ */
+OPT bool oxceStartupProfiler;
 
 OPT bool oxceRecommendedOptionsWereSet;
 OPT std::string password;
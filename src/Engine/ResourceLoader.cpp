@@ -0,0 +1,171 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ResourceLoader.h"
+#include <istream>
+#include "SurfaceSet.h"
+#include "FileMap.h"
+#include "ThreadPool.h"
+#include "Logger.h"
+
+namespace OpenXcom
+{
+
+std::atomic<int> ResourceLoader::_progressDone{ 0 };
+std::atomic<int> ResourceLoader::_progressTotal{ 0 };
+
+/**
+ * Creates empty batch.
+ */
+ResourceLoader::ResourceLoader()
+{
+}
+
+/**
+ * Deletes sets that were not published because of error.
+ */
+ResourceLoader::~ResourceLoader()
+{
+	for (auto& job : _jobs)
+	{
+		delete job.set;
+	}
+}
+
+/**
+ * Adds set loaded from PCK and TAB files, both files are read immediately.
+ * @param name Name of the set in target map.
+ * @param set New set, batch take ownership of it.
+ * @param pck Filename of the PCK image.
+ * @param tab Filename of the TAB offsets.
+ */
+void ResourceLoader::addPck(const std::string &name, SurfaceSet *set, const std::string &pck, const std::string &tab)
+{
+	_jobs.push_back(Job{ name, set, false, nullptr, nullptr, nullptr });
+	auto& job = _jobs.back();
+	++_progressTotal;
+	try
+	{
+		if (!tab.empty())
+		{
+			job.offsets = FileMap::getIStream(tab);
+		}
+		job.image = FileMap::getIStream(pck);
+	}
+	catch (...)
+	{
+		job.error = std::current_exception();
+	}
+}
+
+/**
+ * Adds set loaded from DAT file, file is read immediately.
+ * @param name Name of the set in target map.
+ * @param set New set, batch take ownership of it.
+ * @param dat Filename of the DAT image.
+ */
+void ResourceLoader::addDat(const std::string &name, SurfaceSet *set, const std::string &dat)
+{
+	_jobs.push_back(Job{ name, set, true, nullptr, nullptr, nullptr });
+	auto& job = _jobs.back();
+	++_progressTotal;
+	try
+	{
+		job.image = FileMap::getIStream(dat);
+	}
+	catch (...)
+	{
+		job.error = std::current_exception();
+	}
+}
+
+/**
+ * Decodes all added sets, then puts them into the map, replacing old sets of same name.
+ * If any set fails to load, none are published and first error is rethrown.
+ * @param sets Target map.
+ */
+void ResourceLoader::run(std::map<std::string, SurfaceSet*> &sets)
+{
+	ThreadPool::getShared().parallelFor(_jobs.size(),
+		[&](size_t i, size_t worker)
+		{
+			auto& job = _jobs[i];
+			if (!job.error)
+			{
+				try
+				{
+					if (job.dat)
+					{
+						job.set->loadDat(*job.image);
+					}
+					else
+					{
+						job.set->loadPck(*job.image, job.offsets.get());
+					}
+				}
+				catch (...)
+				{
+					job.error = std::current_exception();
+				}
+			}
+			job.image.reset();
+			job.offsets.reset();
+			++_progressDone;
+		}
+	);
+
+	for (auto& job : _jobs)
+	{
+		if (job.error)
+		{
+			Log(LOG_FATAL) << "Error loading surface set '" << job.name << "'";
+			std::rethrow_exception(job.error);
+		}
+	}
+
+	for (auto& job : _jobs)
+	{
+		auto& target = sets[job.name];
+		delete target;
+		target = job.set;
+		job.set = nullptr;
+	}
+	_jobs.clear();
+}
+
+/**
+ * Gets progress of decoding, safe to call from any thread.
+ * @param total Number of all sets added since last reset.
+ * @return Number of already decoded sets.
+ */
+int ResourceLoader::getProgress(int &total)
+{
+	total = _progressTotal;
+	return _progressDone;
+}
+
+/**
+ * Resets progress counters, called when loading starts.
+ */
+void ResourceLoader::resetProgress()
+{
+	_progressDone = 0;
+	_progressTotal = 0;
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <atomic>
+#include <exception>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace OpenXcom
+{
+
+class SurfaceSet;
+
+/**
+ * Decodes batch of surface sets at once using shared thread pool.
+ * Files are read when a set is added, as archives can't be accessed from multiple threads,
+ * then all sets are decoded in parallel and put into the target map only when all of them are ready.
+ * Progress of decoding can be checked from other threads, e.g. by loading screen.
+ */
+class ResourceLoader
+{
+private:
+	/// One set to decode.
+	struct Job
+	{
+		std::string name;
+		SurfaceSet *set;
+		bool dat;
+		std::unique_ptr<std::istream> image;
+		std::unique_ptr<std::istream> offsets;
+		std::exception_ptr error;
+	};
+
+	std::vector<Job> _jobs;
+
+	static std::atomic<int> _progressDone;
+	static std::atomic<int> _progressTotal;
+
+public:
+	/// Creates empty batch.
+	ResourceLoader();
+	/// Deletes sets that were not published.
+	~ResourceLoader();
+	/// Adds set loaded from PCK/TAB files.
+	void addPck(const std::string &name, SurfaceSet *set, const std::string &pck, const std::string &tab);
+	/// Adds set loaded from DAT file.
+	void addDat(const std::string &name, SurfaceSet *set, const std::string &dat);
+	/// Decodes all sets and puts them into the map.
+	void run(std::map<std::string, SurfaceSet*> &sets);
+
+	/// Gets number of decoded sets and number of all sets added since last reset.
+	static int getProgress(int &total);
+	/// Resets progress counters.
+	static void resetProgress();
+};
+
+}
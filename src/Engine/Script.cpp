@@ -24,6 +24,7 @@
 #include <cmath>
 #include <bitset>
 #include <array>
+#include <chrono>
 
 #include "Logger.h"
 #include "Options.h"
@@ -35,6 +36,8 @@
 #include "Exception.h"
 #include "../fallthrough.h"
 #include "Collections.h"
+#include "ScriptCache.h"
+#include "StartupProfiler.h"
 
 namespace OpenXcom
 {
@@ -65,6 +68,30 @@ namespace OpenXcom
 	MACRO_COPY_64(Func, (Pos) + 0x80) \
 	MACRO_COPY_64(Func, (Pos) + 0xC0)
 
+#define MACRO_LABEL_4(Func, Name, Pos) \
+	Func(Name##0, (Pos) * 4 + 0) \
+	Func(Name##1, (Pos) * 4 + 1) \
+	Func(Name##2, (Pos) * 4 + 2) \
+	Func(Name##3, (Pos) * 4 + 3)
+#define MACRO_LABEL_16(Func, Name, Pos) \
+	MACRO_LABEL_4(Func, Name##0, (Pos) * 4 + 0) \
+	MACRO_LABEL_4(Func, Name##1, (Pos) * 4 + 1) \
+	MACRO_LABEL_4(Func, Name##2, (Pos) * 4 + 2) \
+	MACRO_LABEL_4(Func, Name##3, (Pos) * 4 + 3)
+#define MACRO_LABEL_64(Func, Name, Pos) \
+	MACRO_LABEL_16(Func, Name##0, (Pos) * 4 + 0) \
+	MACRO_LABEL_16(Func, Name##1, (Pos) * 4 + 1) \
+	MACRO_LABEL_16(Func, Name##2, (Pos) * 4 + 2) \
+	MACRO_LABEL_16(Func, Name##3, (Pos) * 4 + 3)
+/**
+ * Same as MACRO_COPY_256 but each position have also unique name usable as label.
+ */
+#define MACRO_LABEL_256(Func) \
+	MACRO_LABEL_64(Func, op_0, 0) \
+	MACRO_LABEL_64(Func, op_1, 1) \
+	MACRO_LABEL_64(Func, op_2, 2) \
+	MACRO_LABEL_64(Func, op_3, 3)
+
 
 ////////////////////////////////////////////////////////////
 //						proc definition
@@ -380,12 +407,28 @@ enum ProcEnum : Uint8
 //					core loop function
 ////////////////////////////////////////////////////////////
 
+/**
+ * Report invalid operation in script.
+ * @param proc array storing operation of script
+ * @param curr position of invalid operation
+ */
+static void scriptExeError(const Uint8* proc, ProgPos curr)
+{
+	static int bugCount = 0;
+	if (++bugCount < 100)
+	{
+		Log(LOG_ERROR) << "Invalid script operation for OpId: " << std::hex << std::showbase << (int)proc[(int)curr] <<" at "<< (int)curr;
+	}
+}
+
 /**
  * Core function in script engine used to executing scripts
  * @param proc array storing operation of script
+ * @param ops if CountOps is set, number of executed operations is added there
  * @return Result of executing script
  */
-static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
+template<bool CountOps = false>
+static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc, size_t* ops = nullptr)
 {
 	ProgPos curr = ProgPos::Start;
 	//--------------------------------------------------
@@ -418,6 +461,10 @@ static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
 
 	while (true)
 	{
+		if (CountOps)
+		{
+			++*ops;
+		}
 		switch (proc[(int)curr++])
 		{
 		MACRO_COPY_256(MACRO_FUNC_ARRAY_LOOP, 0)
@@ -432,16 +479,84 @@ static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
 	//--------------------------------------------------
 
 	errorLabel:
-	static int bugCount = 0;
-	if (++bugCount < 100)
-	{
-		Log(LOG_ERROR) << "Invalid script operation for OpId: " << std::hex << std::showbase << (int)proc[(int)curr] <<" at "<< (int)curr;
-	}
+	scriptExeError(proc, curr);
 
 	endLabel:
 	return;
 }
 
+#ifdef __GNUC__
+#define OXCE_SCRIPT_THREADED
+#endif
+
+#ifdef OXCE_SCRIPT_THREADED
+/**
+ * Version of `scriptExe` that jumps directly from one operation to the next using table of label addresses (GCC extension).
+ * Each operation ends with its own indirect jump, CPU can predict them better than one shared jump of switch.
+ * @param proc array storing operation of script
+ */
+static inline void scriptExeThreaded(ScriptWorkerBase& data, const Uint8* proc)
+{
+	ProgPos curr = ProgPos::Start;
+	//--------------------------------------------------
+	//			helper macros for this function
+	//--------------------------------------------------
+	#define MACRO_FUNC_ARRAY(NAME, ...) + helper::FuncGroup<MACRO_FUNC_ID(NAME)>::FuncList{}
+	#define MACRO_FUNC_LABEL_ADDR(LABEL, POS) &&LABEL,
+	#define MACRO_FUNC_LABEL_IMPL(LABEL, POS) \
+		LABEL: \
+		{ \
+			using currType = helper::GetType<func, POS>; \
+			const auto p = proc + (int)curr; \
+			curr += currType::offset; \
+			const auto ret = currType::func(data, p, curr); \
+			if (ret != RetContinue) \
+			{ \
+				if (ret != RetEnd) \
+				{ \
+					curr += - currType::offset - 1; \
+					scriptExeError(proc, curr); \
+				} \
+				return; \
+			} \
+			goto *labels[proc[(int)curr++]]; \
+		}
+	//--------------------------------------------------
+
+	using func = decltype(MACRO_PROC_DEFINITION(MACRO_FUNC_ARRAY));
+
+	static const void* const labels[256] = { MACRO_LABEL_256(MACRO_FUNC_LABEL_ADDR) };
+
+	goto *labels[proc[(int)curr++]];
+
+	MACRO_LABEL_256(MACRO_FUNC_LABEL_IMPL)
+
+	//--------------------------------------------------
+	//			removing helper macros
+	//--------------------------------------------------
+	#undef MACRO_FUNC_LABEL_IMPL
+	#undef MACRO_FUNC_LABEL_ADDR
+	#undef MACRO_FUNC_ARRAY
+	//--------------------------------------------------
+}
+#endif
+
+/**
+ * Execute script using dispatch mode selected in options.
+ * @param proc array storing operation of script
+ */
+static inline void scriptRun(ScriptWorkerBase& data, const Uint8* proc)
+{
+#ifdef OXCE_SCRIPT_THREADED
+	if (Options::oxceScriptThreadedDispatch)
+	{
+		scriptExeThreaded(data, proc);
+		return;
+	}
+#endif
+	scriptExe(data, proc);
+}
+
 
 ////////////////////////////////////////////////////////////
 //						Script class
@@ -480,18 +595,18 @@ void ScriptWorkerBlit::executeBlit(const Surface* src, Surface* dest, int x, int
 						while (*ptr)
 						{
 							reset(arg);
-							scriptExe(*this, ptr->data());
+							scriptRun(*this, ptr->data());
 							++ptr;
 						}
 						++ptr;
 
 						reset(arg);
-						scriptExe(*this, _proc);
+						scriptRun(*this, _proc);
 
 						while (*ptr)
 						{
 							reset(arg);
-							scriptExe(*this, ptr->data());
+							scriptRun(*this, ptr->data());
 							++ptr;
 						}
 						++ptr;
@@ -513,7 +628,7 @@ void ScriptWorkerBlit::executeBlit(const Surface* src, Surface* dest, int x, int
 					{
 						ScriptWorkerBlit::Output arg = { srcStuff, destStuff };
 						set(arg);
-						scriptExe(*this, _proc);
+						scriptRun(*this, _proc);
 						get(arg);
 						if (arg.getFirst()) destStuff = arg.getFirst();
 					}
@@ -537,7 +652,97 @@ void ScriptWorkerBase::executeBase(const Uint8* proc)
 {
 	if (proc)
 	{
-		scriptExe(*this, proc);
+		scriptRun(*this, proc);
+	}
+}
+
+/**
+ * Logs speed of all available dispatch modes, using test scripts similar to recolor and damage scripts of mods.
+ */
+void ScriptWorkerBase::benchmark()
+{
+	using Parser = ScriptParser<ScriptOutputArgs<int&, int>, int, int>;
+	using Container = Parser::Container;
+	using Worker = Parser::Worker;
+
+	const int repeat = 200000;
+	const std::pair<const char*, const char*> tests[] =
+	{
+		{
+			"recolor",
+			"var int color;\n"
+			"get_color color new_pixel;\n"
+			"if eq color 4;\n"
+			"  set_color new_pixel 9;\n"
+			"  add_shade new_pixel shade;\n"
+			"else;\n"
+			"  offset color 16 anim_frame;\n"
+			"  wavegen_tri color 16 8 8;\n"
+			"  add_shade new_pixel color;\n"
+			"end;\n"
+			"return new_pixel;\n"
+		},
+		{
+			"damage",
+			"var int damage;\n"
+			"var int armor;\n"
+			"set damage new_pixel;\n"
+			"set armor shade;\n"
+			"loop var i blit_part;\n"
+			"  mul armor 2;\n"
+			"  sub damage armor;\n"
+			"  limit_lower damage 0;\n"
+			"  muldiv damage 150 100;\n"
+			"  if gt damage 50;\n"
+			"    sub damage i;\n"
+			"  end;\n"
+			"end;\n"
+			"limit damage 0 200;\n"
+			"return damage;\n"
+		},
+	};
+
+	ScriptGlobal global;
+	Parser parser{ &global, "benchmark", "new_pixel", "shade", "blit_part", "anim_frame" };
+
+	for (const auto& test : tests)
+	{
+		Container script;
+		script.load(test.first, test.second, parser);
+		if (!script)
+		{
+			continue;
+		}
+
+		auto measure = [&](auto func)
+		{
+			Worker worker{ 4, 3 };
+			int sum = 0;
+			const auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < repeat; ++i)
+			{
+				Worker::Output arg = { i & 0xFF, i & 0xF };
+				worker.set(arg);
+				func(worker, script.data());
+				worker.get(arg);
+				sum += arg.getFirst();
+			}
+			const auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+			return std::make_pair(time.count(), sum);
+		};
+
+		size_t ops = 0;
+		measure([&](ScriptWorkerBase& worker, const Uint8* proc) { scriptExe<true>(worker, proc, &ops); });
+
+		auto log = [&](const char *name, std::pair<long long, int> result)
+		{
+			Log(LOG_DEBUG) << "Script benchmark: " << test.first << " " << name << " " << result.first << "us, "
+				<< (result.first ? (long long)(ops * 1000000.0 / result.first) : 0) << " ops/s (checksum " << result.second << ")";
+		};
+		log("switch", measure([&](ScriptWorkerBase& worker, const Uint8* proc) { scriptExe(worker, proc); }));
+#ifdef OXCE_SCRIPT_THREADED
+		log("threaded", measure([&](ScriptWorkerBase& worker, const Uint8* proc) { scriptExeThreaded(worker, proc); }));
+#endif
 	}
 }
 
@@ -829,7 +1034,7 @@ bool parseCustomProc(const ScriptProcData& spd, ParserWriter& ph, const ScriptRe
 	}
 
 	auto argPosEnd = ph.getCurrPos();
-	ph.updateReserved<ScriptFunc>(funcPos, spd.parserGet(argType));
+	ph.updateFunc(funcPos, spd, argType);
 
 	size_t diff = ph.getDiffPos(argPosBegin, argPosEnd);
 	for (int i = 0; i < argRaw::ver(); ++i)
@@ -2114,6 +2319,7 @@ void ParserWriter::relese()
 			++currentText;
 
 			updateReserved<ScriptText>(pos, ScriptText{ charPtr(start) });
+			relocations.push_back(Relocation{ pos.getPos(), RelocText, {}, ArgInvalid, static_cast<size_t>(start), 0 });
 		}
 	);
 }
@@ -2222,6 +2428,27 @@ void ParserWriter::updateProc(ReservedPos<ProcOp> pos, int procOffset)
 	container._proc[static_cast<size_t>(pos.getPos())] += procOffset;
 }
 
+/**
+ * Setting previously prepared place with custom function.
+ * @param pos Position of function.
+ * @param spd Function definition.
+ * @param version Selected version of function.
+ */
+void ParserWriter::updateFunc(ReservedPos<ScriptFunc> pos, const ScriptProcData& spd, int version)
+{
+	updateReserved<ScriptFunc>(pos, spd.parserGet(version));
+
+	auto range = parser.getProc(spd.name);
+	if (range.begin() <= &spd && &spd < range.end())
+	{
+		relocations.push_back(Relocation{ pos.getPos(), RelocFunc, spd.name, ArgInvalid, static_cast<size_t>(&spd - range.begin()), version });
+	}
+	else
+	{
+		cacheable = false;
+	}
+}
+
 /**
  * Try pushing label arg on proc vector.
  * @param s name of label.
@@ -2307,7 +2534,23 @@ bool ParserWriter::pushConstTry(const ScriptRefData& data, ArgEnum type)
 {
 	if (data && data.type == type && !ArgIsReg(data.type) && data.value.type == type)
 	{
+		auto pos = getCurrPos();
 		pushValue(data.value);
+
+		// named values are looked up again when script is loaded from cache, only plain numbers can be stored as is
+		auto ref = parser.getRef(data.name);
+		if (ref == nullptr)
+		{
+			ref = parser.getGlobal()->getRef(data.name);
+		}
+		if (ref && ref->type == data.type && ref->value == data.value)
+		{
+			relocations.push_back(Relocation{ pos, RelocConst, data.name, type, data.value.size, 0 });
+		}
+		else if (type != ArgInt)
+		{
+			cacheable = false;
+		}
 		return true;
 	}
 	return false;
@@ -2774,6 +3017,18 @@ const ScriptRefData* ScriptParserBase::getRef(ScriptRef prefix, ScriptRef postfi
  */
 bool ScriptParserBase::parseBase(ScriptContainerBase& destScript, const std::string& parentName, const std::string& srcCode) const
 {
+	StartupProfiler::Scope profile("script", [&]{ return _name + " " + parentName; });
+	auto* cache = _shared->getCache();
+	std::string cacheKey;
+	if (cache)
+	{
+		cacheKey = ScriptCache::getKey(_name, _regUsedSpace, srcCode);
+		if (cache->find(cacheKey, *this, destScript))
+		{
+			return true;
+		}
+	}
+
 	ScriptContainerBase tempScript;
 	std::string err = "Error in parsing script '" + _name + "' for '" + parentName + "': ";
 	ParserWriter help(
@@ -2814,6 +3069,10 @@ bool ScriptParserBase::parseBase(ScriptContainerBase& destScript, const std::str
 				return false;
 			}
 			help.relese();
+			if (cache && help.cacheable)
+			{
+				cache->add(cacheKey, help);
+			}
 			destScript = std::move(tempScript);
 			return true;
 		}
@@ -3010,6 +3269,69 @@ void ScriptParserBase::load(const YAML::Node& node)
 
 }
 
+/**
+ * Add description of parser to signature used by script cache.
+ * Contains everything that is used to compile script: operations with overloads, types and regs.
+ * Named consts are checked when script is loaded from cache, so only their names and types are added.
+ * @param out String to append to.
+ */
+void ScriptParserBase::addSignature(std::string& out) const
+{
+	auto addNumber = [&](size_t i)
+	{
+		out += std::to_string(i);
+		out += ' ';
+	};
+	auto addName = [&](ScriptRef name)
+	{
+		out.append(name.begin(), name.end());
+		out += ' ';
+	};
+
+	out += _name;
+	out += '\n';
+	addNumber(_regUsedSpace);
+	addNumber(_regOutSize);
+	addNumber(_emptyReturn);
+	out += '\n';
+	for (const auto& t : _typeList)
+	{
+		addName(t.name);
+		addNumber(t.type);
+		addNumber(t.meta.size);
+		out += '\n';
+	}
+	for (const auto& p : _procList)
+	{
+		addName(p.name);
+		addNumber(p.parserGet != nullptr);
+		for (const auto& overload : p.overloadArg)
+		{
+			out += '(';
+			for (const auto& arg : overload)
+			{
+				addNumber(arg);
+			}
+			out += ')';
+		}
+		out += '\n';
+	}
+	for (const auto& r : _refList)
+	{
+		addName(r.name);
+		addNumber(r.type);
+		if (ArgIsReg(r.type))
+		{
+			// position of reg is part of compiled script
+			for (size_t i = 0; i < r.value.size; ++i)
+			{
+				addNumber(reinterpret_cast<const Uint8*>(&r.value.data)[i]);
+			}
+		}
+		out += '\n';
+	}
+}
+
 /**
  * Print all metadata
  */
@@ -3471,6 +3793,15 @@ ScriptGlobal::~ScriptGlobal()
 
 }
 
+/**
+ * Set cache of compiled scripts.
+ * @param cache New cache or null to stop using it.
+ */
+void ScriptGlobal::setCache(std::unique_ptr<ScriptCache> cache)
+{
+	_cache = std::move(cache);
+}
+
 /**
  * Get tag value.
  */
@@ -3629,6 +3960,29 @@ const ScriptRefData* ScriptGlobal::getRef(ScriptRef name, ScriptRef postfix) con
 	return findSortHelper(_refList, name, postfix);
 }
 
+/**
+ * Get description of all build-in operations with their ids and all parsers.
+ * Compiled scripts store ids of operations and positions of regs, change of any of them make them invalid.
+ * @return Text to put in header of script cache.
+ */
+std::string ScriptGlobal::getParserSignature() const
+{
+	std::string out;
+
+	#define MACRO_ALL_SIGNATURE(NAME, IMPL, ARGS, DESC) \
+		out += #NAME " " + std::to_string((int)MACRO_PROC_ID(NAME)) + "\n";
+
+	MACRO_PROC_DEFINITION(MACRO_ALL_SIGNATURE)
+
+	#undef MACRO_ALL_SIGNATURE
+
+	for (const auto& p : _parserNames)
+	{
+		p.second->addSignature(out);
+	}
+	return out;
+}
+
 /**
  * Prepare for loading data.
  */
@@ -3648,6 +4002,11 @@ void ScriptGlobal::endLoad()
 	}
 	_parserNames.clear();
 	_parserEvents.clear();
+
+	if (Options::debug)
+	{
+		ScriptWorkerBase::benchmark();
+	}
 }
 
 /**
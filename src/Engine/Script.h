@@ -19,6 +19,7 @@
  */
 #include <map>
 #include <limits>
+#include <memory>
 #include <vector>
 #include <string>
 #include <cstring>
@@ -44,6 +45,7 @@ class ScriptParserBase;
 class ScriptParserEventsBase;
 class ScriptContainerBase;
 class ScriptContainerEventsBase;
+class ScriptCache;
 
 struct ParserWriter;
 class SelectedToken;
@@ -373,6 +375,7 @@ struct TypeInfo
 class ScriptContainerBase
 {
 	friend struct ParserWriter;
+	friend class ScriptCache;
 	std::vector<Uint8> _proc;
 
 public:
@@ -449,6 +452,13 @@ public:
 	{
 		return _events;
 	}
+
+	/// Test if script or any global event will be run.
+	bool hasAnyScript() const
+	{
+		// events are two lists each ended by empty script, one before and one after `_current`
+		return _current || (_events && (_events[0] || _events[1]));
+	}
 };
 
 /**
@@ -727,6 +737,9 @@ public:
 	void log_buffer_add(FuncRef<std::string()> func);
 	/// Flush buffer to log file.
 	void log_buffer_flush(ProgPos& p);
+
+	/// Logs speed of all script dispatch modes.
+	static void benchmark();
 };
 
 /**
@@ -1309,6 +1322,8 @@ public:
 
 	/// Show all script informations.
 	void logScriptMetadata(bool haveEvents, const std::string& groupName) const;
+	/// Add description of everything that affects compiled scripts.
+	void addSignature(std::string& out) const;
 
 	/// Get name of script.
 	const std::string& getName() const { return _name; }
@@ -1615,6 +1630,7 @@ private:
 	std::map<ArgEnum, TagData> _tagNames;
 	std::vector<TagValueType> _tagValueTypes;
 	std::vector<ScriptRefData> _refList;
+	std::unique_ptr<ScriptCache> _cache;
 
 	/// Get tag value.
 	size_t getTag(ArgEnum type, ScriptRef s) const;
@@ -1648,6 +1664,13 @@ public:
 	/// Get global ref data.
 	const ScriptRefData* getRef(ScriptRef name, ScriptRef postfix = {}) const;
 
+	/// Get description of operations and all parsers, compiled scripts are valid only with same one.
+	std::string getParserSignature() const;
+	/// Set cache of compiled scripts, used only during loading.
+	void setCache(std::unique_ptr<ScriptCache> cache);
+	/// Get cache of compiled scripts, null if scripts are not cached.
+	ScriptCache* getCache() const { return _cache.get(); }
+
 	/// Get all tag names
 	const std::map<ArgEnum, TagData> &getTagNames() const { return _tagNames; }
 
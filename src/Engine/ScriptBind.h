@@ -95,6 +95,29 @@ struct ParserWriter
 	/// Tag type representing position script operation id in proc vector.
 	class ProcOp { };
 
+	/// Kind of value in proc vector that is valid only in current run.
+	enum RelocEnum : Uint8
+	{
+		RelocText,
+		RelocFunc,
+		RelocConst,
+	};
+
+	/// Value in proc vector that need to be restored when script is loaded from cache.
+	struct Relocation
+	{
+		ProgPos pos;
+		RelocEnum kind;
+		/// Name of function or const.
+		ScriptRef name;
+		/// Type of const.
+		ArgEnum type;
+		/// Offset of text, index of function overload or size of const.
+		size_t value;
+		/// Version of function.
+		int version;
+	};
+
 	/// List of all places in proc vector where we need have same values
 	template<typename T, typename CompType = T>
 	class ReservedCrossRefrenece
@@ -161,6 +184,11 @@ struct ParserWriter
 	/// Store position of blocks of code like "if" or "while".
 	std::vector<Block> codeBlocks;
 
+	/// List of values that depend on current run.
+	std::vector<Relocation> relocations;
+	/// Can script be stored in cache?
+	bool cacheable = true;
+
 
 
 	/// Constructor.
@@ -209,6 +237,9 @@ struct ParserWriter
 	/// Updating previously added proc operation id.
 	void updateProc(ReservedPos<ProcOp> pos, int procOffset);
 
+	/// Setting previously prepared place with custom function.
+	void updateFunc(ReservedPos<ScriptFunc> pos, const ScriptProcData& spd, int version);
+
 	/// Try pushing label arg on proc vector. Can't use this to create loop back label.
 	bool pushLabelTry(const ScriptRefData& data);
 
@@ -0,0 +1,369 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ScriptCache.h"
+#include <SDL.h>
+#include "Script.h"
+#include "ScriptBind.h"
+#include "CrossPlatform.h"
+#include "Exception.h"
+#include "Logger.h"
+#include "SDL2Helpers.h"
+#include "../md5.h"
+#include "../version.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+/// Start of header of cache file, change of format or engine version invalidates whole cache.
+const std::string CacheHeader = std::string("OXCE script cache 1 ") + OPENXCOM_VERSION_ENGINE + OPENXCOM_VERSION_GIT + " " + std::to_string(sizeof(void*));
+
+void writeSize(std::string &out, size_t size)
+{
+	do
+	{
+		Uint8 b = size & 0x7F;
+		size >>= 7;
+		out.push_back((char)(size ? b | 0x80 : b));
+	} while (size);
+}
+
+void writeString(std::string &out, const std::string &str)
+{
+	writeSize(out, str.size());
+	out.append(str);
+}
+
+/**
+ * Reads data written by functions above, throws on truncated or corrupted data.
+ */
+struct CacheReader
+{
+	const char *curr;
+	const char *end;
+
+	Uint8 readByte()
+	{
+		if (curr == end)
+		{
+			throw Exception("Unexpected end of script cache");
+		}
+		return (Uint8)*curr++;
+	}
+
+	size_t readSize()
+	{
+		size_t size = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			Uint8 b = readByte();
+			size |= (size_t)(b & 0x7F) << shift;
+			if ((b & 0x80) == 0)
+			{
+				return size;
+			}
+		}
+		throw Exception("Invalid size in script cache");
+	}
+
+	const char *readData(size_t size)
+	{
+		if (size > (size_t)(end - curr))
+		{
+			throw Exception("Unexpected end of script cache");
+		}
+		auto data = curr;
+		curr += size;
+		return data;
+	}
+
+	std::string readString()
+	{
+		size_t size = readSize();
+		return std::string(readData(size), size);
+	}
+};
+
+} // namespace
+
+/**
+ * Creates empty cache.
+ * Hash of parser signature is part of header, any change of operations or parsers invalidates whole cache,
+ * even between builds with same version.
+ * @param path Full path of cache file.
+ * @param parserSignature Description of operations and parsers, from `ScriptGlobal::getParserSignature`.
+ */
+ScriptCache::ScriptCache(const std::string &path, const std::string &parserSignature) : _path(path), _changed(false)
+{
+	MD5 md5;
+	md5.update(parserSignature.data(), parserSignature.size());
+	md5.finalize();
+	_header = CacheHeader + " " + md5.hexdigest();
+}
+
+/**
+ * Cleans up the cache.
+ */
+ScriptCache::~ScriptCache()
+{
+}
+
+/**
+ * Reads all entries from cache file.
+ * Missing, outdated or broken file is ignored, cache is then rebuilt from scratch.
+ */
+void ScriptCache::load()
+{
+	_entries.clear();
+	_used.clear();
+	_changed = false;
+
+	if (!CrossPlatform::fileExists(_path))
+	{
+		_changed = true;
+		return;
+	}
+
+	SDL_RWops *rwops = SDL_RWFromFile(_path.c_str(), "rb");
+	if (!rwops)
+	{
+		_changed = true;
+		return;
+	}
+	size_t size = 0;
+	char *data = (char *)SDL_LoadFile_RW(rwops, &size, SDL_TRUE);
+	if (!data)
+	{
+		_changed = true;
+		return;
+	}
+
+	try
+	{
+		CacheReader reader{ data, data + size };
+		if (reader.readString() != _header)
+		{
+			throw Exception("Script cache version changed");
+		}
+		size_t count = reader.readSize();
+		for (size_t i = 0; i < count; ++i)
+		{
+			std::string key = reader.readString();
+			_entries[key] = reader.readString();
+		}
+		Log(LOG_VERBOSE) << "Script cache: " << _entries.size() << " entries loaded";
+	}
+	catch (Exception &e)
+	{
+		Log(LOG_INFO) << "Script cache ignored: " << e.what();
+		_entries.clear();
+		_changed = true;
+	}
+	SDL_free(data);
+}
+
+/**
+ * Writes entries used in this run to cache file.
+ * Entries of scripts that were changed or removed are dropped.
+ */
+void ScriptCache::save()
+{
+	if (!_changed && _used.size() == _entries.size())
+	{
+		return;
+	}
+
+	std::string out;
+	writeString(out, _header);
+	writeSize(out, _used.size());
+	for (const auto& p : _used)
+	{
+		writeString(out, p.first);
+		writeString(out, p.second);
+	}
+	if (CrossPlatform::writeFile(_path, out))
+	{
+		Log(LOG_VERBOSE) << "Script cache: " << _used.size() << " entries saved";
+	}
+	_changed = false;
+}
+
+/**
+ * Calculates key of script.
+ * @param parserName Name of parser, same code can compile differently for each parser.
+ * @param regUsed Space used by parser registers.
+ * @param srcCode Code of script.
+ * @return MD5 hash of all arguments.
+ */
+std::string ScriptCache::getKey(const std::string &parserName, size_t regUsed, const std::string &srcCode)
+{
+	std::string header = parserName + '\n' + std::to_string(regUsed) + '\n';
+	MD5 md5;
+	md5.update(header.data(), header.size());
+	md5.update(srcCode.data(), srcCode.size());
+	md5.finalize();
+	return md5.hexdigest();
+}
+
+/**
+ * Restores compiled script from cache.
+ * All relocations are resolved again using current parser, any missing or changed name is cache miss.
+ * @param key Key of script.
+ * @param parser Parser that would compile this script.
+ * @param script Script to fill, unchanged if script is not found.
+ * @return True if script was restored.
+ */
+bool ScriptCache::find(const std::string &key, const ScriptParserBase &parser, ScriptContainerBase &script)
+{
+	auto it = _entries.find(key);
+	if (it == _entries.end())
+	{
+		return false;
+	}
+
+	try
+	{
+		CacheReader reader{ it->second.data(), it->second.data() + it->second.size() };
+		size_t procSize = reader.readSize();
+		auto procData = reader.readData(procSize);
+
+		ScriptContainerBase temp;
+		temp._proc.assign(procData, procData + procSize);
+
+		auto place = [&](size_t pos, size_t size) -> Uint8*
+		{
+			if (pos > procSize || size > procSize - pos)
+			{
+				throw Exception("Invalid relocation in script cache");
+			}
+			return temp._proc.data() + pos;
+		};
+
+		size_t count = reader.readSize();
+		for (size_t i = 0; i < count; ++i)
+		{
+			auto kind = (ParserWriter::RelocEnum)reader.readByte();
+			size_t pos = reader.readSize();
+			switch (kind)
+			{
+			case ParserWriter::RelocText:
+			{
+				size_t offset = reader.readSize();
+				ScriptText text = { (const char*)place(offset, 1) };
+				memcpy(place(pos, sizeof(text)), &text, sizeof(text));
+				break;
+			}
+			case ParserWriter::RelocFunc:
+			{
+				std::string name = reader.readString();
+				size_t index = reader.readSize();
+				int version = (int)reader.readSize();
+				auto range = parser.getProc(ScriptRef::tempFrom(name));
+				if (index >= range.size() || range.begin()[index].parserGet == nullptr)
+				{
+					return false;
+				}
+				ScriptFunc func = range.begin()[index].parserGet(version);
+				memcpy(place(pos, sizeof(func)), &func, sizeof(func));
+				break;
+			}
+			case ParserWriter::RelocConst:
+			{
+				std::string name = reader.readString();
+				auto type = (ArgEnum)reader.readSize();
+				size_t size = reader.readSize();
+				auto ref = parser.getRef(ScriptRef::tempFrom(name));
+				if (ref == nullptr)
+				{
+					ref = parser.getGlobal()->getRef(ScriptRef::tempFrom(name));
+				}
+				if (ref == nullptr || ref->type != type || ArgIsReg(ref->type) || ref->value.type != type || ref->value.size != size)
+				{
+					return false;
+				}
+				memcpy(place(pos, size), &ref->value.data, size);
+				break;
+			}
+			default:
+				throw Exception("Invalid relocation in script cache");
+			}
+		}
+		if (reader.curr != reader.end)
+		{
+			return false;
+		}
+
+		script = std::move(temp);
+		_used[key] = it->second;
+		return true;
+	}
+	catch (Exception &)
+	{
+		return false;
+	}
+}
+
+/**
+ * Adds compiled script to cache.
+ * @param key Key of script.
+ * @param writer Parser state after script was successfully compiled.
+ */
+void ScriptCache::add(const std::string &key, const ParserWriter &writer)
+{
+	// values of relocations are cleared, they are meaningless in other runs
+	std::vector<Uint8> proc = writer.container._proc;
+	for (const auto& r : writer.relocations)
+	{
+		size_t size = r.kind == ParserWriter::RelocText ? sizeof(ScriptText) : r.kind == ParserWriter::RelocFunc ? sizeof(ScriptFunc) : r.value;
+		memset(proc.data() + static_cast<size_t>(r.pos), 0, size);
+	}
+
+	std::string out;
+	writeSize(out, proc.size());
+	out.append((const char*)proc.data(), proc.size());
+	writeSize(out, writer.relocations.size());
+	for (const auto& r : writer.relocations)
+	{
+		out.push_back((char)r.kind);
+		writeSize(out, static_cast<size_t>(r.pos));
+		switch (r.kind)
+		{
+		case ParserWriter::RelocText:
+			writeSize(out, r.value);
+			break;
+		case ParserWriter::RelocFunc:
+			writeString(out, r.name.toString());
+			writeSize(out, r.value);
+			writeSize(out, (size_t)r.version);
+			break;
+		case ParserWriter::RelocConst:
+			writeString(out, r.name.toString());
+			writeSize(out, (size_t)r.type);
+			writeSize(out, r.value);
+			break;
+		}
+	}
+
+	_used[key] = std::move(out);
+	_changed = true;
+}
+
+}
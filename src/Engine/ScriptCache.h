@@ -0,0 +1,65 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <unordered_map>
+
+namespace OpenXcom
+{
+
+class ScriptParserBase;
+class ScriptContainerBase;
+struct ParserWriter;
+
+/**
+ * On disk cache of compiled scripts.
+ * Each script is stored as its proc vector with list of relocations, keyed by MD5 hash of parser name and script code.
+ * Values that are valid only in current run (texts, custom functions, named consts and tags) are looked up again by name
+ * when script is restored, if any of them is not available anymore then script is parsed again.
+ */
+class ScriptCache
+{
+private:
+	std::string _path;
+	/// Header of cache file, depends on engine version and parsers.
+	std::string _header;
+	/// Entries read from disk.
+	std::unordered_map<std::string, std::string> _entries;
+	/// Entries used in this run, only these are written back.
+	std::unordered_map<std::string, std::string> _used;
+	bool _changed;
+
+public:
+	/// Creates empty cache stored in given file.
+	ScriptCache(const std::string &path, const std::string &parserSignature);
+	/// Cleans up the cache.
+	~ScriptCache();
+	/// Reads cache file, if it exists and match current version.
+	void load();
+	/// Writes used entries to cache file, if anything changed.
+	void save();
+	/// Calculates key of script.
+	static std::string getKey(const std::string &parserName, size_t regUsed, const std::string &srcCode);
+	/// Restores compiled script from cache.
+	bool find(const std::string &key, const ScriptParserBase &parser, ScriptContainerBase &script);
+	/// Adds compiled script to cache.
+	void add(const std::string &key, const ParserWriter &writer);
+};
+
+}
@@ -0,0 +1,350 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ShaderSpan.h"
+#include <algorithm>
+#include <chrono>
+#include "ShaderDraw.h"
+#include "ShaderMove.h"
+#include "Options.h"
+#include "Logger.h"
+
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && !defined(__e2k__)
+#define OXCE_SHADER_SPAN_X86
+#endif
+
+#ifdef OXCE_SHADER_SPAN_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+#endif
+
+#ifdef __GNUC__
+// allow using instructions that are not enabled for whole program, CPU support is checked at runtime
+#define OXCE_TARGET(x) __attribute__((target(x)))
+#else
+#define OXCE_TARGET(x)
+#endif
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+/**
+ * Draws row of pixels one by one, same as `ShaderDraw<helper::StandardShade>`.
+ */
+void shadeRowScalar(Uint8 *dest, const Uint8 *src, int count, int shade)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		helper::StandardShade::func(dest[i], src[i], shade);
+	}
+}
+
+#ifdef OXCE_SHADER_SPAN_X86
+
+/**
+ * Draws row of pixels, 16 at once.
+ */
+OXCE_TARGET("sse2") void shadeRowSSE2(Uint8 *dest, const Uint8 *src, int count, int shade)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i shadeV = _mm_set1_epi8((char)shade);
+	const __m128i groupV = _mm_set1_epi8((char)helper::ColorGroup);
+	const __m128i blackV = _mm_set1_epi8((char)helper::ColorShade);
+
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i transparent = _mm_cmpeq_epi8(s, zero);
+		if (_mm_movemask_epi8(transparent) == 0xFFFF)
+		{
+			continue;
+		}
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+
+		// so dark it would flip over to another color - make it black instead
+		__m128i n = _mm_add_epi8(s, shadeV);
+		const __m128i sameGroup = _mm_cmpeq_epi8(_mm_and_si128(_mm_xor_si128(n, s), groupV), zero);
+		n = _mm_or_si128(_mm_and_si128(sameGroup, n), _mm_andnot_si128(sameGroup, blackV));
+
+		_mm_storeu_si128((__m128i*)(dest + i), _mm_or_si128(_mm_and_si128(transparent, d), _mm_andnot_si128(transparent, n)));
+	}
+	shadeRowScalar(dest + i, src + i, count - i, shade);
+}
+
+/**
+ * Draws row of pixels, 32 at once.
+ */
+OXCE_TARGET("avx2") void shadeRowAVX2(Uint8 *dest, const Uint8 *src, int count, int shade)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i shadeV = _mm256_set1_epi8((char)shade);
+	const __m256i groupV = _mm256_set1_epi8((char)helper::ColorGroup);
+	const __m256i blackV = _mm256_set1_epi8((char)helper::ColorShade);
+
+	int i = 0;
+	for (; i + 32 <= count; i += 32)
+	{
+		const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+		const __m256i transparent = _mm256_cmpeq_epi8(s, zero);
+		if (_mm256_movemask_epi8(transparent) == -1)
+		{
+			continue;
+		}
+		const __m256i d = _mm256_loadu_si256((const __m256i*)(dest + i));
+
+		// so dark it would flip over to another color - make it black instead
+		__m256i n = _mm256_add_epi8(s, shadeV);
+		const __m256i sameGroup = _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_xor_si256(n, s), groupV), zero);
+		n = _mm256_blendv_epi8(blackV, n, sameGroup);
+
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_blendv_epi8(n, d, transparent));
+	}
+	shadeRowSSE2(dest + i, src + i, count - i, shade);
+}
+
+/**
+ * Checks if CPU and OS support AVX2 instructions.
+ */
+bool haveAVX2()
+{
+#ifdef __GNUC__
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+	int CPUInfo[4];
+	__cpuid(CPUInfo, 0);
+	if (CPUInfo[0] < 7)
+	{
+		return false;
+	}
+	__cpuid(CPUInfo, 1);
+	// OSXSAVE and AVX bits, OS need save YMM registers too
+	if ((CPUInfo[2] & 0x18000000) != 0x18000000 || (_xgetbv(0) & 0x6) != 0x6)
+	{
+		return false;
+	}
+	__cpuidex(CPUInfo, 7, 0);
+	return (CPUInfo[1] & 0x20) ? true : false;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Checks if CPU support SSE2 instructions.
+ */
+bool haveSSE2()
+{
+#ifdef __GNUC__
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#elif defined(_MSC_VER)
+	int CPUInfo[4];
+	__cpuid(CPUInfo, 1);
+	return (CPUInfo[3] & 0x04000000) ? true : false;
+#else
+	return false;
+#endif
+}
+
+#endif
+
+/// Size of test buffers, not multiple of vector size to check tail handling too.
+constexpr int TestSize = 16 * 37 + 11;
+
+/**
+ * Fills test buffers with all possible pixel values, transparent runs and random garbage.
+ */
+void fillTest(Uint8 *src, Uint8 *dest)
+{
+	Uint32 seed = 0x12345678;
+	for (int i = 0; i < TestSize; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		src[i] = (i / 40) % 3 == 0 ? 0 : (Uint8)(i < 256 ? i : seed >> 16);
+		dest[i] = (Uint8)(seed >> 24);
+	}
+}
+
+} // namespace
+
+/**
+ * Gets implementation used on this CPU, selected on first use.
+ * @return Implementation.
+ */
+const ShaderSpan::Impl &ShaderSpan::getImpl()
+{
+	static const Impl impl = selectImpl();
+	return impl;
+}
+
+/**
+ * Selects fastest implementation that CPU supports and that gives same results as `ShaderDraw`.
+ * @return Implementation.
+ */
+ShaderSpan::Impl ShaderSpan::selectImpl()
+{
+	if (Options::debug)
+	{
+		benchmark();
+	}
+
+	std::vector<Impl> candidates;
+#ifdef OXCE_SHADER_SPAN_X86
+	if (haveAVX2())
+	{
+		candidates.push_back(Impl{ "AVX2", &shadeRowAVX2 });
+	}
+	if (haveSSE2())
+	{
+		candidates.push_back(Impl{ "SSE2", &shadeRowSSE2 });
+	}
+#endif
+
+	for (const auto& impl : candidates)
+	{
+		if (checkImpl(impl))
+		{
+			Log(LOG_INFO) << "Using " << impl.name << " terrain blit routine.";
+			return impl;
+		}
+		Log(LOG_ERROR) << "Terrain blit routine " << impl.name << " gives wrong results, skipping it.";
+	}
+	return Impl{ "scalar", &shadeRowScalar };
+}
+
+/**
+ * Checks if implementation gives same results as `ShaderDraw` for all pixel values and a range of shades.
+ * @param impl Implementation to check.
+ * @return True if all results are same.
+ */
+bool ShaderSpan::checkImpl(const Impl &impl)
+{
+	Uint8 src[TestSize];
+	Uint8 destInit[TestSize];
+	Uint8 destImpl[TestSize];
+	Uint8 destRef[TestSize];
+	fillTest(src, destInit);
+
+	for (int shade = -16; shade <= 32; ++shade)
+	{
+		std::copy(destInit, destInit + TestSize, destImpl);
+		std::copy(destInit, destInit + TestSize, destRef);
+
+		impl.row(destImpl, src, TestSize, shade);
+		ShaderDraw<helper::StandardShade>(ShaderSurface(SurfaceRaw<Uint8>(destRef, TestSize, 1)), ShaderMove<const Uint8>(SurfaceRaw<const Uint8>(src, TestSize, 1)), ShaderScalar(shade));
+
+		if (!std::equal(destImpl, destImpl + TestSize, destRef))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Logs time needed by `ShaderDraw` and all implementations supported by CPU to draw same test data.
+ */
+void ShaderSpan::benchmark()
+{
+	const int repeat = 2000;
+	Uint8 src[TestSize];
+	Uint8 dest[TestSize];
+	fillTest(src, dest);
+
+	auto measure = [&](const char *name, auto func)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < repeat; ++i)
+		{
+			func(i & 15);
+		}
+		const auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+		Log(LOG_DEBUG) << "Terrain blit benchmark: " << name << " " << time.count() << "us";
+	};
+
+	measure("ShaderDraw", [&](int shade)
+	{
+		ShaderDraw<helper::StandardShade>(ShaderSurface(SurfaceRaw<Uint8>(dest, TestSize, 1)), ShaderMove<const Uint8>(SurfaceRaw<const Uint8>(src, TestSize, 1)), ShaderScalar(shade));
+	});
+	measure("scalar", [&](int shade) { shadeRowScalar(dest, src, TestSize, shade); });
+#ifdef OXCE_SHADER_SPAN_X86
+	if (haveSSE2())
+	{
+		measure("SSE2", [&](int shade) { shadeRowSSE2(dest, src, TestSize, shade); });
+	}
+	if (haveAVX2())
+	{
+		measure("AVX2", [&](int shade) { shadeRowAVX2(dest, src, TestSize, shade); });
+	}
+#endif
+}
+
+/**
+ * Gets name of implementation used on this CPU.
+ * @return Name.
+ */
+const char *ShaderSpan::getName()
+{
+	return getImpl().name;
+}
+
+/**
+ * Draws surface with shade, skipping transparent pixels.
+ * Gives same result as `ShaderDraw<helper::StandardShade>` with `ShaderMove`.
+ * @param dest Destination surface.
+ * @param src Source surface.
+ * @param x X position of source on destination.
+ * @param y Y position of source on destination.
+ * @param shade Shade offset.
+ * @param half Draw only right half of source.
+ */
+void ShaderSpan::blitShade(SurfaceRaw<Uint8> dest, SurfaceRaw<const Uint8> src, int x, int y, int shade, bool half)
+{
+	if (!dest || !src)
+	{
+		return;
+	}
+
+	const int begX = std::max(x + (half ? src.getWidth() / 2 : 0), 0);
+	const int endX = std::min(x + src.getWidth(), dest.getWidth());
+	const int begY = std::max(y, 0);
+	const int endY = std::min(y + src.getHeight(), dest.getHeight());
+	if (begX >= endX || begY >= endY)
+	{
+		return;
+	}
+
+	const RowFunc row = getImpl().row;
+	Uint8 *destRow = dest.getBuffer() + begY * dest.getPitch() + begX;
+	const Uint8 *srcRow = src.getBuffer() + (begY - y) * src.getPitch() + (begX - x);
+	for (int i = begY; i < endY; ++i)
+	{
+		row(destRow, srcRow, endX - begX, shade);
+		destRow += dest.getPitch();
+		srcRow += src.getPitch();
+	}
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Surface.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Vectorized version of `ShaderDraw<helper::StandardShade>` used by battlescape terrain drawing.
+ * Sprites are drawn row by row, using SSE2 or AVX2 when CPU supports it.
+ * Result is always same as `ShaderDraw`, selected implementation is checked against it on first use.
+ */
+class ShaderSpan
+{
+public:
+	/// Function drawing one row of pixels.
+	using RowFunc = void (*)(Uint8 *dest, const Uint8 *src, int count, int shade);
+
+private:
+	/// Implementation of row drawing.
+	struct Impl
+	{
+		const char *name;
+		RowFunc row;
+	};
+
+	/// Gets implementation used on this CPU.
+	static const Impl &getImpl();
+	/// Selects best implementation that gives correct results.
+	static Impl selectImpl();
+	/// Checks if implementation gives same results as `ShaderDraw`.
+	static bool checkImpl(const Impl &impl);
+	/// Logs speed of all available implementations.
+	static void benchmark();
+
+public:
+	/// Gets name of implementation used on this CPU.
+	static const char *getName();
+	/// Draws one row of sprite with shade, skipping transparent pixels.
+	static void shadeRow(Uint8 *dest, const Uint8 *src, int count, int shade) { getImpl().row(dest, src, count, shade); }
+	/// Draws surface with shade, skipping transparent pixels.
+	static void blitShade(SurfaceRaw<Uint8> dest, SurfaceRaw<const Uint8> src, int x, int y, int shade, bool half = false);
+};
+
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "StartupProfiler.h"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "CrossPlatform.h"
+#include "Logger.h"
+#include "Options.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+/// One finished event.
+struct ProfilerEvent
+{
+	const char *category;
+	std::string name;
+	StartupProfiler::Clock::duration start;
+	StartupProfiler::Clock::duration time;
+	size_t thread;
+};
+
+std::atomic<bool> active{ false };
+std::mutex eventsMutex;
+std::vector<ProfilerEvent> events;
+std::map<std::thread::id, size_t> threads;
+StartupProfiler::Clock::time_point reportStart = {};
+
+/// Writes string as JSON literal.
+void writeJsonString(std::ostream &out, const std::string &str)
+{
+	out << '"';
+	for (unsigned char c : str)
+	{
+		if (c == '"' || c == '\\')
+		{
+			out << '\\' << c;
+		}
+		else if (c < 0x20)
+		{
+			out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec << std::setfill(' ');
+		}
+		else
+		{
+			out << c;
+		}
+	}
+	out << '"';
+}
+
+/// Converts time to microseconds used by trace format.
+long long toMicroseconds(StartupProfiler::Clock::duration time)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+}
+
+/// Converts time to milliseconds used in log.
+double toMilliseconds(StartupProfiler::Clock::duration time)
+{
+	return std::chrono::duration<double, std::milli>(time).count();
+}
+
+}
+
+/**
+ * Starts new report, old events are dropped.
+ * Does nothing if `oxceStartupProfiler` option is disabled.
+ */
+void StartupProfiler::begin()
+{
+	std::lock_guard<std::mutex> lock(eventsMutex);
+	events.clear();
+	threads.clear();
+	threads[std::this_thread::get_id()] = 0;
+	reportStart = Clock::now();
+	active = Options::oxceStartupProfiler;
+}
+
+/**
+ * Stops recording, writes all events to report file and summary to log.
+ */
+void StartupProfiler::end()
+{
+	if (!active)
+	{
+		return;
+	}
+	active = false;
+
+	std::lock_guard<std::mutex> lock(eventsMutex);
+
+	std::ostringstream out;
+	out << "{\"traceEvents\":[\n";
+	for (const auto& t : threads)
+	{
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t.second << ",\"args\":{\"name\":";
+		writeJsonString(out, t.second == 0 ? "loading" : "worker " + std::to_string(t.second));
+		out << "}},\n";
+	}
+	for (size_t i = 0; i < events.size(); ++i)
+	{
+		const auto& e = events[i];
+		out << "{\"name\":";
+		writeJsonString(out, e.name);
+		out << ",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread;
+		out << ",\"ts\":" << toMicroseconds(e.start) << ",\"dur\":" << toMicroseconds(e.time) << "}";
+		out << (i + 1 < events.size() ? ",\n" : "\n");
+	}
+	out << "],\"displayTimeUnit\":\"ms\"}\n";
+
+	std::string path = Options::getUserFolder() + "startup-profile.json";
+	if (CrossPlatform::writeFile(path, out.str()))
+	{
+		Log(LOG_INFO) << "Startup profile written to " << path;
+	}
+
+	// summary: time of each category and slowest events
+	std::map<std::string, Clock::duration> categories;
+	for (const auto& e : events)
+	{
+		categories[e.category] += e.time;
+	}
+	Log(LOG_INFO) << "Startup profile: total " << std::fixed << std::setprecision(1) << toMilliseconds(Clock::now() - reportStart) << " ms";
+	for (const auto& c : categories)
+	{
+		Log(LOG_INFO) << "  " << c.first << ": " << std::fixed << std::setprecision(1) << toMilliseconds(c.second) << " ms";
+	}
+
+	std::vector<const ProfilerEvent*> slowest;
+	for (const auto& e : events)
+	{
+		if (std::string(e.category) != "phase")
+		{
+			slowest.push_back(&e);
+		}
+	}
+	size_t count = std::min<size_t>(slowest.size(), 10);
+	std::partial_sort(slowest.begin(), slowest.begin() + count, slowest.end(),
+		[](const ProfilerEvent *a, const ProfilerEvent *b) { return a->time > b->time; }
+	);
+	for (size_t i = 0; i < count; ++i)
+	{
+		Log(LOG_INFO) << "  slowest " << slowest[i]->category << ": " << slowest[i]->name << " " << std::fixed << std::setprecision(1) << toMilliseconds(slowest[i]->time) << " ms";
+	}
+
+	events.clear();
+	threads.clear();
+}
+
+/**
+ * Checks if events are recorded now.
+ * @return True between begin() and end() when profiling is enabled.
+ */
+bool StartupProfiler::isActive()
+{
+	return active;
+}
+
+/**
+ * Adds finished event to report.
+ * @param category Kind of event (phase, mod, file...).
+ * @param name Name of event.
+ * @param start When event started.
+ * @param end When event ended.
+ */
+void StartupProfiler::record(const char *category, std::string &&name, Clock::time_point start, Clock::time_point end)
+{
+	std::lock_guard<std::mutex> lock(eventsMutex);
+	if (!active)
+	{
+		return;
+	}
+	auto thread = threads.insert(std::make_pair(std::this_thread::get_id(), threads.size())).first->second;
+	events.push_back(ProfilerEvent{ category, std::move(name), start - reportStart, end - start, thread });
+}
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <string>
+#include <utility>
+
+namespace OpenXcom
+{
+
+/**
+ * Records time spent in phases of startup and mod loading, down to single ruleset files and scripts.
+ * Enabled by `oxceStartupProfiler` option, report is written in Chrome trace format to `startup-profile.json`
+ * in user folder (can be opened in chrome://tracing or Perfetto) and summary of slowest parts is written to log.
+ * Events can be recorded from any thread, each thread get separate row in report.
+ */
+class StartupProfiler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * Measures time from creation to destruction and records it as one event.
+	 */
+	class Scope
+	{
+		const char *_category;
+		std::string _name;
+		bool _active;
+		Clock::time_point _start;
+
+	public:
+		/// Starts measuring.
+		Scope(const char *category, const std::string &name) : _category{ category }, _active{ isActive() }
+		{
+			if (_active)
+			{
+				_name = name;
+				_start = Clock::now();
+			}
+		}
+		/// Starts measuring, name is created by function only when profiling is enabled.
+		template<typename F, typename = decltype(std::declval<F&>()())>
+		Scope(const char *category, F &&getName) : _category{ category }, _active{ isActive() }
+		{
+			if (_active)
+			{
+				_name = getName();
+				_start = Clock::now();
+			}
+		}
+		/// Stops measuring.
+		~Scope()
+		{
+			if (_active)
+			{
+				record(_category, std::move(_name), _start, Clock::now());
+			}
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+private:
+	/// Adds finished event to report.
+	static void record(const char *category, std::string &&name, Clock::time_point start, Clock::time_point end);
+
+public:
+	/// Starts new report, if profiling is enabled.
+	static void begin();
+	/// Writes report to file and log.
+	static void end();
+	/// Are events recorded now?
+	static bool isActive();
+};
+
+}
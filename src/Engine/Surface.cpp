@@ -19,6 +19,7 @@
 #include "Surface.h"
 #include "ShaderDraw.h"
 #include "ShaderMove.h"
+#include "ShaderSpan.h"
 #include <vector>
 #include <algorithm>
 #include <SDL_gfxPrimitives.h>
@@ -938,22 +939,23 @@ void Surface::unlock()
  */
 void Surface::blitRaw(SurfaceRaw<Uint8> destSurf, SurfaceRaw<const Uint8> srcSurf, int x, int y, int shade, bool half, int newBaseColor)
 {
-	ShaderMove<const Uint8> src(srcSurf, x, y);
-	if (half)
-	{
-		GraphSubset g = src.getDomain();
-		g.beg_x = g.end_x/2;
-		src.setDomain(g);
-	}
 	if (newBaseColor)
 	{
+		ShaderMove<const Uint8> src(srcSurf, x, y);
+		if (half)
+		{
+			GraphSubset g = src.getDomain();
+			g.beg_x = g.end_x/2;
+			src.setDomain(g);
+		}
 		--newBaseColor;
 		newBaseColor <<= 4;
 		ShaderDraw<helper::ColorReplace>(ShaderSurface(destSurf), src, ShaderScalar(shade), ShaderScalar(newBaseColor));
 	}
 	else
 	{
-		ShaderDraw<helper::StandardShade>(ShaderSurface(destSurf), src, ShaderScalar(shade));
+		// most common case, use vectorized version
+		ShaderSpan::blitShade(destSurf, srcSurf, x, y, shade, half);
 	}
 }
 
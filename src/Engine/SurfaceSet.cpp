@@ -52,15 +52,31 @@ SurfaceSet::~SurfaceSet()
  * @sa http://www.ufopaedia.org/index.php?title=Image_Formats#PCK
  */
 void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
+{
+	std::unique_ptr<std::istream> offsetFile;
+	if (!tab.empty())
+	{
+		offsetFile = FileMap::getIStream(tab);
+	}
+	auto imgFile = FileMap::getIStream(pck);
+	loadPck(*imgFile, offsetFile.get());
+}
+
+/**
+ * Loads the contents of an X-Com set of PCK/TAB image files
+ * from already opened streams, do not access any files so can be used from any thread.
+ * @param imgFile Content of the PCK image.
+ * @param offsetFile Content of the TAB offsets, or null if set have only one frame.
+ */
+void SurfaceSet::loadPck(std::istream &imgFile, std::istream *offsetFile)
 {
 	_frames.clear();
 
 	int nframes = 0;
 
 	// Load TAB and get image offsets
-	if (!tab.empty())
+	if (offsetFile)
 	{
-		auto offsetFile = FileMap::getIStream(tab);
 		std::streampos begin, end;
 		begin = offsetFile->tellg();
 		int off;
@@ -89,7 +105,6 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
 		_frames.push_back(Surface(_width, _height));
 	}
 
-	auto imgFile = FileMap::getIStream(pck);
 	Uint8 value;
 
 	for (int frame = 0; frame < nframes; ++frame)
@@ -99,7 +114,7 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
 		// Lock the surface
 		_frames[frame].lock();
 
-		imgFile->read((char*)&value, 1);
+		imgFile.read((char*)&value, 1);
 		for (int i = 0; i < value; ++i)
 		{
 			for (int j = 0; j < _width; ++j)
@@ -108,11 +123,11 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
 			}
 		}
 
-		while (imgFile->read((char*)&value, 1) && value != 255)
+		while (imgFile.read((char*)&value, 1) && value != 255)
 		{
 			if (value == 254)
 			{
-				imgFile->read((char*)&value, 1);
+				imgFile.read((char*)&value, 1);
 				for (int i = 0; i < value; ++i)
 				{
 					_frames[frame].setPixelIterative(&x, &y, 0);
@@ -138,13 +153,23 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
  * @sa http://www.ufopaedia.org/index.php?title=Image_Formats#SCR_.26_DAT
  */
 void SurfaceSet::loadDat(const std::string &filename)
+{
+	auto imgFile = FileMap::getIStream(filename);
+	loadDat(*imgFile);
+}
+
+/**
+ * Loads the contents of an X-Com DAT image file
+ * from already opened stream, do not access any files so can be used from any thread.
+ * @param imgFile Content of the DAT image.
+ */
+void SurfaceSet::loadDat(std::istream &imgFile)
 {
 	int nframes = 0;
 
-	auto imgFile = FileMap::getIStream(filename);
-	imgFile->seekg(0, std::ios::end);
-	std::streamoff size = imgFile->tellg();
-	imgFile->seekg(0, std::ios::beg);
+	imgFile.seekg(0, std::ios::end);
+	std::streamoff size = imgFile.tellg();
+	imgFile.seekg(0, std::ios::beg);
 
 	nframes = (int)size / (_width * _height);
 
@@ -160,7 +185,7 @@ void SurfaceSet::loadDat(const std::string &filename)
 	// Lock the surface
 	_frames[frame].lock();
 
-	while (imgFile->read((char*)&value, 1))
+	while (imgFile.read((char*)&value, 1))
 	{
 		_frames[frame].setPixelIterative(&x, &y, value);
 
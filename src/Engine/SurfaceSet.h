@@ -20,6 +20,7 @@
 
 #include <vector>
 #include <string>
+#include <iosfwd>
 #include <SDL.h>
 
 namespace OpenXcom
@@ -56,8 +57,12 @@ public:
 
 	/// Loads an X-Com set of PCK/TAB image files.
 	void loadPck(const std::string &pck, const std::string &tab = "");
+	/// Loads an X-Com set of PCK/TAB images from memory.
+	void loadPck(std::istream &imgFile, std::istream *offsetFile);
 	/// Loads an X-Com DAT image file.
 	void loadDat(const std::string &filename);
+	/// Loads an X-Com DAT image from memory.
+	void loadDat(std::istream &imgFile);
 	/// Gets a particular frame from the set.
 	Surface *getFrame(int i);
 	/// Gets a particular frame from the set.
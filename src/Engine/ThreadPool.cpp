@@ -0,0 +1,207 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ThreadPool.h"
+#include "Options.h"
+#include "Logger.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+/// Index of worker running on current thread.
+thread_local size_t currentWorker = 0;
+
+/// Set when main thread is already inside `parallelFor`.
+thread_local bool insideParallelFor = false;
+
+}
+
+/**
+ * Creates pool and starts worker threads.
+ * @param threads Number of threads to start, calling thread is not counted.
+ */
+ThreadPool::ThreadPool(size_t threads) : _job(nullptr), _jobCount(0), _jobNext(0), _threadsWorking(0), _generation(0), _quit(false)
+{
+	_threads.reserve(threads);
+	for (size_t i = 0; i < threads; ++i)
+	{
+		_threads.emplace_back(&ThreadPool::workerLoop, this, i + 1);
+	}
+}
+
+/**
+ * Wakes up all threads and waits for them to exit.
+ */
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_quit = true;
+	}
+	_wakeUp.notify_all();
+	for (auto& t : _threads)
+	{
+		t.join();
+	}
+}
+
+/**
+ * Gets pool shared by whole game, created on first use.
+ * Size is controlled by `oxceWorkerThreads` option, 0 mean one worker for each CPU core.
+ * @return Shared pool.
+ */
+ThreadPool &ThreadPool::getShared()
+{
+	static ThreadPool pool(
+		[]
+		{
+			size_t workers = Options::oxceWorkerThreads > 0 ? (size_t)Options::oxceWorkerThreads : (size_t)std::thread::hardware_concurrency();
+			workers = std::max(workers, (size_t)1);
+			Log(LOG_INFO) << "Worker threads: " << workers;
+			return workers - 1;
+		}()
+	);
+	return pool;
+}
+
+/**
+ * Gets index of worker that runs on current thread.
+ * @return Value from zero to `getWorkerCount() - 1`.
+ */
+size_t ThreadPool::getCurrentWorker()
+{
+	return currentWorker;
+}
+
+/**
+ * Runs jobs of current batch until none are left.
+ * @param worker Index of worker.
+ */
+void ThreadPool::runJobs(size_t worker)
+{
+	while (true)
+	{
+		const size_t i = _jobNext++;
+		if (i >= _jobCount)
+		{
+			return;
+		}
+		try
+		{
+			(*_job)(i, worker);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (!_error)
+			{
+				_error = std::current_exception();
+			}
+			_jobNext = _jobCount;
+			return;
+		}
+	}
+}
+
+/**
+ * Waits for new batch of jobs and helps run it.
+ * @param worker Index of worker.
+ */
+void ThreadPool::workerLoop(size_t worker)
+{
+	currentWorker = worker;
+	size_t generation = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wakeUp.wait(lock, [&]{ return _quit || _generation != generation; });
+			if (_quit)
+			{
+				return;
+			}
+			generation = _generation;
+		}
+
+		runJobs(worker);
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (--_threadsWorking == 0)
+			{
+				_finished.notify_all();
+			}
+		}
+	}
+}
+
+/**
+ * Runs `count` jobs on all workers and waits for them to finish.
+ * Nested calls or calls from worker threads run serially on the calling thread.
+ * Exception thrown by any job is rethrown here after all workers stop.
+ * @param count Number of jobs.
+ * @param job Function called for each job index.
+ */
+void ThreadPool::parallelFor(size_t count, const Job &job)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	if (_threads.empty() || count == 1 || currentWorker != 0 || insideParallelFor)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			job(i, currentWorker);
+		}
+		return;
+	}
+
+	insideParallelFor = true;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_job = &job;
+		_jobCount = count;
+		_jobNext = 0;
+		_threadsWorking = _threads.size();
+		_error = nullptr;
+		++_generation;
+	}
+	_wakeUp.notify_all();
+
+	runJobs(0);
+
+	std::exception_ptr error;
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_finished.wait(lock, [&]{ return _threadsWorking == 0; });
+		_job = nullptr;
+		std::swap(error, _error);
+	}
+	insideParallelFor = false;
+
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+}
+
+}
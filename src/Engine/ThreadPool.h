@@ -0,0 +1,76 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <functional>
+
+namespace OpenXcom
+{
+
+/**
+ * Pool of worker threads used to split heavy calculations into independent jobs.
+ * Jobs must not touch any shared state that is not read-only for the whole run,
+ * all results should be written to buffers indexed by job or worker number
+ * and merged by caller afterwards in fixed order.
+ */
+class ThreadPool
+{
+public:
+	/// Function called for each job, get job index and worker index.
+	using Job = std::function<void(size_t index, size_t worker)>;
+
+private:
+	std::vector<std::thread> _threads;
+	std::mutex _mutex;
+	std::condition_variable _wakeUp, _finished;
+	const Job *_job;
+	size_t _jobCount;
+	std::atomic<size_t> _jobNext;
+	size_t _threadsWorking;
+	size_t _generation;
+	bool _quit;
+	std::exception_ptr _error;
+
+	/// Main loop of worker thread.
+	void workerLoop(size_t worker);
+	/// Run jobs until all are taken.
+	void runJobs(size_t worker);
+public:
+	/// Creates pool with given number of additional threads.
+	ThreadPool(size_t threads);
+	/// Stops all threads.
+	~ThreadPool();
+
+	/// Gets pool shared by whole game.
+	static ThreadPool &getShared();
+	/// Gets index of current worker, main thread is always zero.
+	static size_t getCurrentWorker();
+
+	/// Gets how many workers can run at once, including calling thread.
+	size_t getWorkerCount() const { return _threads.size() + 1; }
+	/// Runs `count` jobs and waits for all of them to finish.
+	void parallelFor(size_t count, const Job &job);
+};
+
+}
@@ -47,6 +47,7 @@
 #include "../Savegame/Craft.h"
 #include "../Mod/RuleCraft.h"
 #include "../Savegame/Ufo.h"
+#include "../Savegame/GlobeSpatialHash.h"
 #include "../Mod/RuleUfo.h"
 #include "../Mod/RuleArcScript.h"
 #include "../Mod/RuleEventScript.h"
@@ -851,31 +852,37 @@ void GeoscapeState::timeAdvance()
 	}
 
 
-	for (int i = 0; i < timeSpan && !_pause; ++i)
+	// in fast forward, keep simulating whole spans until one tick of the clock is used up or something needs the player
+	const bool fastForward = Options::oxceGeoFastForward && _timeSpeed == _btn1Day;
+	const Uint32 start = SDL_GetTicks();
+	do
 	{
-		TimeTrigger trigger;
-		trigger = _game->getSavedGame()->getTime()->advance();
-		switch (trigger)
+		for (int i = 0; i < timeSpan && !_pause; ++i)
 		{
-		case TIME_1MONTH:
-			time1Month();
-			FALLTHROUGH;
-		case TIME_1DAY:
-			time1Day();
-			FALLTHROUGH;
-		case TIME_1HOUR:
-			time1Hour();
-			FALLTHROUGH;
-		case TIME_30MIN:
-			time30Minutes();
-			FALLTHROUGH;
-		case TIME_10MIN:
-			time10Minutes();
-			FALLTHROUGH;
-		case TIME_5SEC:
-			time5Seconds();
+			TimeTrigger trigger;
+			trigger = _game->getSavedGame()->getTime()->advance();
+			switch (trigger)
+			{
+			case TIME_1MONTH:
+				time1Month();
+				FALLTHROUGH;
+			case TIME_1DAY:
+				time1Day();
+				FALLTHROUGH;
+			case TIME_1HOUR:
+				time1Hour();
+				FALLTHROUGH;
+			case TIME_30MIN:
+				time30Minutes();
+				FALLTHROUGH;
+			case TIME_10MIN:
+				time10Minutes();
+				FALLTHROUGH;
+			case TIME_5SEC:
+				time5Seconds();
+			}
 		}
-	}
+	} while (fastForward && _timeSpeed == _btn1Day && !_pause && _dogfightsToBeStarted.empty() && _game->isState(this) && _game->getSavedGame()->getEnding() == END_NONE && SDL_GetTicks() - start < (Uint32)Options::geoClockSpeed);
 
 	_pause = !_dogfightsToBeStarted.empty() || _zoomInEffectTimer->isRunning() || _zoomOutEffectTimer->isRunning();
 
@@ -1103,21 +1110,13 @@ void GeoscapeState::time5Seconds()
 		{
 			if ((*j)->isDestroyed())
 			{
-				for (std::vector<Country*>::iterator country = _game->getSavedGame()->getCountries()->begin(); country != _game->getSavedGame()->getCountries()->end(); ++country)
+				if (Country *country = _game->getSavedGame()->findCountry((*j)->getLongitude(), (*j)->getLatitude()))
 				{
-					if ((*country)->getRules()->insideCountry((*j)->getLongitude(), (*j)->getLatitude()))
-					{
-						(*country)->addActivityXcom(-(*j)->getRules()->getScore());
-						break;
-					}
+					country->addActivityXcom(-(*j)->getRules()->getScore());
 				}
-				for (std::vector<Region*>::iterator region = _game->getSavedGame()->getRegions()->begin(); region != _game->getSavedGame()->getRegions()->end(); ++region)
+				if (Region *region = _game->getSavedGame()->findRegion((*j)->getLongitude(), (*j)->getLatitude()))
 				{
-					if ((*region)->getRules()->insideRegion((*j)->getLongitude(), (*j)->getLatitude()))
-					{
-						(*region)->addActivityXcom(-(*j)->getRules()->getScore());
-						break;
-					}
+					region->addActivityXcom(-(*j)->getRules()->getScore());
 				}
 				// if a transport craft has been shot down, kill all the soldiers on board.
 				if ((*j)->getRules()->getMaxUnits() > 0)
@@ -1530,14 +1529,37 @@ void GeoscapeState::time10Minutes()
 			}
 		}
 	}
+	// Only UFOs close enough to a base can detect it.
+	auto* ufos = _game->getSavedGame()->getUfos();
+	int ufoSightRange = 0;
+	for (auto* ufo : *ufos)
+	{
+		ufoSightRange = std::max(ufoSightRange, ufo->getCraftStats().sightRange);
+	}
+	GlobeSpatialHash<Ufo> ufoHash;
+	ufoHash.build(*ufos, Nautical(ufoSightRange));
+	std::vector<size_t> nearUfos;
+	auto detectedByUfo = [&](const Base *base)
+	{
+		// Find a UFO that detected this base, if any.
+		ufoHash.find(base->getLongitude(), base->getLatitude(), Nautical(ufoSightRange), nearUfos);
+		DetectXCOMBase detect(*base);
+		for (size_t u : nearUfos)
+		{
+			if (detect(ufos->at(u)))
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
 	if (Options::aggressiveRetaliation)
 	{
 		// Detect as many bases as possible.
 		for (std::vector<Base*>::iterator iBase = _game->getSavedGame()->getBases()->begin(); iBase != _game->getSavedGame()->getBases()->end(); ++iBase)
 		{
-			// Find a UFO that detected this base, if any.
-			std::vector<Ufo*>::const_iterator uu = std::find_if (_game->getSavedGame()->getUfos()->begin(), _game->getSavedGame()->getUfos()->end(), DetectXCOMBase(**iBase));
-			if (uu != _game->getSavedGame()->getUfos()->end())
+			if (detectedByUfo(*iBase))
 			{
 				// Base found
 				(*iBase)->setRetaliationTarget(true);
@@ -1550,9 +1572,7 @@ void GeoscapeState::time10Minutes()
 		std::map<const Region *, Base *> discovered;
 		for (std::vector<Base*>::iterator iBase = _game->getSavedGame()->getBases()->begin(); iBase != _game->getSavedGame()->getBases()->end(); ++iBase)
 		{
-			// Find a UFO that detected this base, if any.
-			std::vector<Ufo*>::const_iterator uu = std::find_if (_game->getSavedGame()->getUfos()->begin(), _game->getSavedGame()->getUfos()->end(), DetectXCOMBase(**iBase));
-			if (uu != _game->getSavedGame()->getUfos()->end())
+			if (detectedByUfo(*iBase))
 			{
 				discovered[_game->getSavedGame()->locateRegion(**iBase)] = *iBase;
 			}
@@ -1572,6 +1592,19 @@ void GeoscapeState::ufoHuntingAndEscorting()
 {
 	auto* activeCrafts = updateActiveCrafts();
 
+	// Only craft inside radar range of UFO can be hunted.
+	int ufoRadarRange = 0;
+	for (auto* ufo : *_game->getSavedGame()->getUfos())
+	{
+		if (ufo->isHunterKiller())
+		{
+			ufoRadarRange = std::max(ufoRadarRange, ufo->getCraftStats().radarRange);
+		}
+	}
+	GlobeSpatialHash<Craft> craftHash;
+	craftHash.build(*activeCrafts, Nautical(ufoRadarRange));
+	std::vector<size_t> nearCrafts;
+
 	for (std::vector<Ufo*>::iterator ufo = _game->getSavedGame()->getUfos()->begin(); ufo != _game->getSavedGame()->getUfos()->end(); ++ufo)
 	{
 		if ((*ufo)->isHunterKiller() && (*ufo)->getStatus() == Ufo::FLYING)
@@ -1594,8 +1627,10 @@ void GeoscapeState::ufoHuntingAndEscorting()
 			}
 
 			// look for more attractive target
-			for (auto* craft : *activeCrafts)
+			craftHash.find((*ufo)->getLongitude(), (*ufo)->getLatitude(), Nautical((*ufo)->getCraftStats().radarRange), nearCrafts);
+			for (size_t c : nearCrafts)
 			{
+				auto* craft = activeCrafts->at(c);
 				if (!craft->isIgnoredByHK() && !craft->getRules()->isUndetectable())
 				{
 					int tmpAttraction = craft->getHunterKillerAttraction((*ufo)->getHuntMode());
@@ -1662,6 +1697,16 @@ void GeoscapeState::baseHunting()
 {
 	auto* activeCrafts = updateActiveCrafts();
 
+	// Only craft inside detection range of alien base can be hunted.
+	double baseDetectionRange = 0;
+	for (auto* ab : *_game->getSavedGame()->getAlienBases())
+	{
+		baseDetectionRange = std::max(baseDetectionRange, ab->getDeployment()->getBaseDetectionRange());
+	}
+	GlobeSpatialHash<Craft> craftHash;
+	craftHash.build(*activeCrafts, Nautical(baseDetectionRange));
+	std::vector<size_t> nearCrafts;
+
 	for (std::vector<AlienBase*>::iterator ab = _game->getSavedGame()->getAlienBases()->begin(); ab != _game->getSavedGame()->getAlienBases()->end(); ++ab)
 	{
 		if ((*ab)->getDeployment()->getBaseDetectionRange() > 0)
@@ -1674,8 +1719,10 @@ void GeoscapeState::baseHunting()
 			{
 				// Look for nearby craft
 				bool started = false;
-				for (auto* craft : *activeCrafts)
+				craftHash.find((*ab)->getLongitude(), (*ab)->getLatitude(), Nautical((*ab)->getDeployment()->getBaseDetectionRange()), nearCrafts);
+				for (size_t c : nearCrafts)
 				{
+					auto* craft = activeCrafts->at(c);
 					// Craft is flying (i.e. not in base)
 					if (craft->getStatus() == "STR_OUT" && !craft->isDestroyed() && !craft->getRules()->isUndetectable())
 					{
@@ -1921,9 +1968,32 @@ void GeoscapeState::time30Minutes()
 	// can be updated by previous loop
 	auto* activeCrafts = updateActiveCrafts();
 
+	// Only bases and craft with radar range reaching UFO can detect it, unless scripts change detection.
+	int baseRadarRange = 0;
+	for (auto* base : *_game->getSavedGame()->getBases())
+	{
+		baseRadarRange = std::max(baseRadarRange, base->getMaxRadarRange());
+	}
+	int craftRadarRange = 0;
+	for (auto* craft : *activeCrafts)
+	{
+		craftRadarRange = std::max(craftRadarRange, craft->getCraftStats().radarRange);
+	}
+	// base radar check is done on rounded down distance
+	const double baseDetectRange = Nautical(baseRadarRange + 1);
+	const double craftDetectRange = Nautical(craftRadarRange);
+	GlobeSpatialHash<Base> baseHash;
+	baseHash.build(*_game->getSavedGame()->getBases(), baseDetectRange);
+	GlobeSpatialHash<Craft> craftHash;
+	craftHash.build(*activeCrafts, craftDetectRange);
+	std::vector<size_t> nearBases, nearCrafts;
+
 	// Handle UFO detection and give aliens points
-	for (auto* ufo : *_game->getSavedGame()->getUfos())
+	std::vector<std::pair<Region*, Country*>> ufoAreas;
+	_game->getSavedGame()->locateAreas(*_game->getSavedGame()->getUfos(), ufoAreas);
+	for (size_t u = 0; u < _game->getSavedGame()->getUfos()->size(); ++u)
 	{
+		auto* ufo = _game->getSavedGame()->getUfos()->at(u);
 		// instant retaliation missions are ignored (UFOs shouldn't be detected)
 		if (ufo->getMission()->getRules().getObjective() == OBJECTIVE_INSTANT_RETALIATION)
 		{
@@ -1938,22 +2008,14 @@ void GeoscapeState::time30Minutes()
 			FALLTHROUGH;
 		case Ufo::FLYING:
 			// Get area
-			for (auto* region : *_game->getSavedGame()->getRegions())
+			if (auto* region = ufoAreas[u].first)
 			{
-				if (region->getRules()->insideRegion(ufo->getLongitude(), ufo->getLatitude()))
-				{
-					region->addActivityAlien(points);
-					break;
-				}
+				region->addActivityAlien(points);
 			}
 			// Get country
-			for (auto* country : *_game->getSavedGame()->getCountries())
+			if (auto* country = ufoAreas[u].second)
 			{
-				if (country->getRules()->insideCountry(ufo->getLongitude(), ufo->getLatitude()))
-				{
-					country->addActivityAlien(points);
-					break;
-				}
+				country->addActivityAlien(points);
 			}
 
 			// Detection ufo state
@@ -1971,14 +2033,56 @@ void GeoscapeState::time30Minutes()
 				bool alreadyTracked = ufo->getDetected();
 				SavedGame* save = _game->getSavedGame();
 
-				for (auto* base : *_game->getSavedGame()->getBases())
+				if (ufo->getRules()->getScript<ModScript::DetectUfoFromBase>().hasAnyScript())
 				{
-					detected = maskBitOr(detected, base->detect(ufo, save, alreadyTracked));
+					for (auto* base : *_game->getSavedGame()->getBases())
+					{
+						detected = maskBitOr(detected, base->detect(ufo, save, alreadyTracked));
+					}
+				}
+				else
+				{
+					baseHash.find(ufo->getLongitude(), ufo->getLatitude(), baseDetectRange, nearBases);
+					auto nearBase = nearBases.begin();
+					for (size_t b = 0; b < _game->getSavedGame()->getBases()->size(); ++b)
+					{
+						if (nearBase != nearBases.end() && *nearBase == b)
+						{
+							detected = maskBitOr(detected, _game->getSavedGame()->getBases()->at(b)->detect(ufo, save, alreadyTracked));
+							++nearBase;
+						}
+						else
+						{
+							// out of range, roll zero chance like `Base::detect` would, to keep same random sequence
+							RNG::percent(0);
+						}
+					}
 				}
 
-				for (auto* craft : *activeCrafts)
+				if (ufo->getRules()->getScript<ModScript::DetectUfoFromCraft>().hasAnyScript())
 				{
-					detected = maskBitOr(detected, craft->detect(ufo, save, alreadyTracked));
+					for (auto* craft : *activeCrafts)
+					{
+						detected = maskBitOr(detected, craft->detect(ufo, save, alreadyTracked));
+					}
+				}
+				else
+				{
+					craftHash.find(ufo->getLongitude(), ufo->getLatitude(), craftDetectRange, nearCrafts);
+					auto nearCraft = nearCrafts.begin();
+					for (size_t c = 0; c < activeCrafts->size(); ++c)
+					{
+						if (nearCraft != nearCrafts.end() && *nearCraft == c)
+						{
+							detected = maskBitOr(detected, activeCrafts->at(c)->detect(ufo, save, alreadyTracked));
+							++nearCraft;
+						}
+						else
+						{
+							// out of range, roll zero chance like `Craft::detect` would, to keep same random sequence
+							RNG::percent(0);
+						}
+					}
 				}
 
 				if (!alreadyTracked)
@@ -2627,21 +2731,13 @@ void GeoscapeState::time1Day()
 	// handle regional and country points for alien bases
 	for (std::vector<AlienBase*>::const_iterator b = saveGame->getAlienBases()->begin(); b != saveGame->getAlienBases()->end(); ++b)
 	{
-		for (std::vector<Region*>::iterator k = saveGame->getRegions()->begin(); k != saveGame->getRegions()->end(); ++k)
+		if (Region *region = saveGame->findRegion((*b)->getLongitude(), (*b)->getLatitude()))
 		{
-			if ((*k)->getRules()->insideRegion((*b)->getLongitude(), (*b)->getLatitude()))
-			{
-				(*k)->addActivityAlien((*b)->getDeployment()->getPoints());
-				break;
-			}
+			region->addActivityAlien((*b)->getDeployment()->getPoints());
 		}
-		for (std::vector<Country*>::iterator k = saveGame->getCountries()->begin(); k != saveGame->getCountries()->end(); ++k)
+		if (Country *country = saveGame->findCountry((*b)->getLongitude(), (*b)->getLatitude()))
 		{
-			if ((*k)->getRules()->insideCountry((*b)->getLongitude(), (*b)->getLatitude()))
-			{
-				(*k)->addActivityAlien((*b)->getDeployment()->getPoints());
-				break;
-			}
+			country->addActivityAlien((*b)->getDeployment()->getPoints());
 		}
 	}
 
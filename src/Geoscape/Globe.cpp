@@ -323,7 +323,7 @@ struct CreateShadow
  * @param y Y position in pixels.
  */
 Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y) : InteractiveSurface(width, height, x, y), _cenX(cenX), _cenY(cenY), _rotLon(0.0), _rotLat(0.0), _hoverLon(0.0), _hoverLat(0.0), _craftLon(0.0), _craftLat(0.0), _craftRange(0.0), _game(game), _hover(false), _craft(false), _blink(-1),
-																					_isMouseScrolling(false), _isMouseScrolled(false), _xBeforeMouseScrolling(0), _yBeforeMouseScrolling(0), _lonBeforeMouseScrolling(0.0), _latBeforeMouseScrolling(0.0), _mouseScrollingStartTime(0), _totalMouseMoveX(0), _totalMouseMoveY(0), _mouseMovedOverThreshold(false)
+																					_isMouseScrolling(false), _isMouseScrolled(false), _xBeforeMouseScrolling(0), _yBeforeMouseScrolling(0), _lonBeforeMouseScrolling(0.0), _latBeforeMouseScrolling(0.0), _mouseScrollingStartTime(0), _totalMouseMoveX(0), _totalMouseMoveY(0), _mouseMovedOverThreshold(false), _landCached(false)
 {
 	_rules = game->getMod()->getGlobe();
 	_texture = new SurfaceSet(*_game->getMod()->getSurfaceSet("TEXTURE.DAT"));
@@ -944,10 +944,32 @@ void Globe::draw()
 	if (_redraw)
 	{
 		cachePolygons();
+		_landCached = false;
 	}
 	Surface::draw();
-	drawOcean();
-	drawLand();
+	if (_landCached)
+	{
+		// view did not change, only copy back ocean and land
+		lock();
+		for (int y = 0; y < getHeight(); ++y)
+		{
+			std::copy_n(_landCache.data() + y * getWidth(), getWidth(), getRaw(0, y));
+		}
+		unlock();
+	}
+	else
+	{
+		drawOcean();
+		drawLand();
+		_landCache.resize(getWidth() * getHeight());
+		lock();
+		for (int y = 0; y < getHeight(); ++y)
+		{
+			std::copy_n(getRaw(0, y), getWidth(), _landCache.data() + y * getWidth());
+		}
+		unlock();
+		_landCached = true;
+	}
 	drawRadars();
 	drawFlights();
 	drawShadow();
@@ -78,6 +78,9 @@ private:
 	Uint32 _mouseScrollingStartTime;
 	int _totalMouseMoveX, _totalMouseMoveY;
 	bool _mouseMovedOverThreshold;
+	/// Pixels of ocean and land drawn for current view, reused until the globe is moved.
+	std::vector<Uint8> _landCache;
+	bool _landCached;
 
 	/// Sets the globe zoom factor.
 	void setZoom(size_t zoom);
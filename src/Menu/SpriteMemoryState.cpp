@@ -0,0 +1,123 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SpriteMemoryState.h"
+#include <algorithm>
+#include <sstream>
+#include "../Engine/Game.h"
+#include "../Engine/LocalizedText.h"
+#include "../Engine/Options.h"
+#include "../Interface/Text.h"
+#include "../Interface/TextButton.h"
+#include "../Interface/TextList.h"
+#include "../Interface/Window.h"
+#include "../Mod/Mod.h"
+#include "../Mod/SpriteResidency.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Initializes all the elements in the Sprite Memory screen.
+ */
+SpriteMemoryState::SpriteMemoryState()
+{
+	_screen = false;
+
+	// Create objects
+	_window = new Window(this, 320, 200, 0, 0, POPUP_BOTH);
+	_txtTitle = new Text(300, 17, 10, 8);
+	_txtTotal = new Text(300, 9, 10, 26);
+	_lstSprites = new TextList(284, 136, 10, 38);
+	_btnOk = new TextButton(100, 16, 110, 178);
+
+	// Set palette
+	setInterface("tests");
+
+	add(_window, "window", "tests");
+	add(_txtTitle, "heading", "tests");
+	add(_txtTotal, "text", "tests");
+	add(_lstSprites, "text", "tests");
+	add(_btnOk, "button2", "tests");
+
+	centerAllSurfaces();
+
+	// Set up objects
+	setWindowBackground(_window, "tests");
+
+	_txtTitle->setBig();
+	_txtTitle->setAlign(ALIGN_CENTER);
+	_txtTitle->setText("Sprite memory");
+
+	const SpriteResidency &residency = _game->getMod()->getSpriteResidency();
+	std::ostringstream total;
+	total << "Loaded: " << residency.getResidentBytes() / 1024 << " KB";
+	if (Options::oxceSpriteMemoryBudget > 0 && Options::lazyLoadResources)
+	{
+		total << ", budget: " << Options::oxceSpriteMemoryBudget * 1024 << " KB";
+	}
+	else
+	{
+		total << ", no budget";
+	}
+	_txtTotal->setText(total.str());
+
+	// biggest first
+	std::vector<std::pair<std::string, SpriteResidency::Entry>> entries(residency.getEntries().begin(), residency.getEntries().end());
+	std::sort(entries.begin(), entries.end(),
+		[](const std::pair<std::string, SpriteResidency::Entry> &a, const std::pair<std::string, SpriteResidency::Entry> &b)
+		{
+			return a.second.bytes > b.second.bytes;
+		}
+	);
+
+	_lstSprites->setColumns(3, 180, 60, 44);
+	_lstSprites->setSelectable(true);
+	_lstSprites->setBackground(_window);
+	_lstSprites->setMargin(2);
+	for (const auto& e : entries)
+	{
+		std::ostringstream size;
+		size << e.second.bytes / 1024 << " KB";
+		_lstSprites->addRow(3, e.first.c_str(), size.str().c_str(), e.second.evictable ? "" : "fixed");
+	}
+
+	_btnOk->setText(tr("STR_OK"));
+	_btnOk->onMouseClick((ActionHandler)&SpriteMemoryState::btnOkClick);
+	_btnOk->onKeyboardPress((ActionHandler)&SpriteMemoryState::btnOkClick, Options::keyOk);
+	_btnOk->onKeyboardPress((ActionHandler)&SpriteMemoryState::btnOkClick, Options::keyCancel);
+}
+
+/**
+ * Cleans up the Sprite Memory state.
+ */
+SpriteMemoryState::~SpriteMemoryState()
+{
+
+}
+
+/**
+ * Returns to the previous screen.
+ * @param action Pointer to an action.
+ */
+void SpriteMemoryState::btnOkClick(Action *)
+{
+	_game->popState();
+}
+
+}
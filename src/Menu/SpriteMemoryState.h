@@ -0,0 +1,49 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "../Engine/State.h"
+
+namespace OpenXcom
+{
+
+class Window;
+class Text;
+class TextButton;
+class TextList;
+
+/**
+ * Debug screen showing memory used by sprites loaded from mods.
+ */
+class SpriteMemoryState : public State
+{
+private:
+	Window *_window;
+	Text *_txtTitle, *_txtTotal;
+	TextList *_lstSprites;
+	TextButton *_btnOk;
+public:
+	/// Creates the Sprite Memory state.
+	SpriteMemoryState();
+	/// Cleans up the Sprite Memory state.
+	~SpriteMemoryState();
+	/// Handler for clicking the OK button.
+	void btnOkClick(Action *action);
+};
+
+}
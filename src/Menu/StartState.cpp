@@ -30,6 +30,8 @@
 #include "../Engine/Font.h"
 #include "../Engine/Timer.h"
 #include "../Engine/CrossPlatform.h"
+#include "../Engine/ResourceLoader.h"
+#include "../Engine/StartupProfiler.h"
 #include "../Interface/FpsCounter.h"
 #include "../Interface/Cursor.h"
 #include "../Interface/Text.h"
@@ -162,6 +164,7 @@ void StartState::think()
 	{
 	case LOADING_FAILED:
 		CrossPlatform::flashWindow();
+		_progress.clear();
 		addLine("");
 		addLine("ERROR: " + error);
 		addLine("");
@@ -277,6 +280,22 @@ void StartState::animate()
 				break;
 			}
 		}
+
+		if (Options::oxceStartUpTextMode < 2)
+		{
+			int total = 0;
+			int done = ResourceLoader::getProgress(total);
+			std::string progress;
+			if (done < total)
+			{
+				progress = "Decoding sprites " + std::to_string(done) + "/" + std::to_string(total);
+			}
+			if (progress != _progress)
+			{
+				_progress = progress;
+				updateText();
+			}
+		}
 	}
 }
 
@@ -288,7 +307,23 @@ void StartState::animate()
 void StartState::addLine(const std::string &str)
 {
 	_output << "\n" << str;
-	_text->setText(_output.str());
+	updateText();
+}
+
+/**
+ * Shows terminal output, with progress of loading
+ * as temporary last line, and moves the cursor after it.
+ */
+void StartState::updateText()
+{
+	if (_progress.empty())
+	{
+		_text->setText(_output.str());
+	}
+	else
+	{
+		_text->setText(_output.str() + "\n" + _progress);
+	}
 	int y = _text->getTextHeight() - _font->getHeight();
 	int x = _text->getTextWidth(y / _font->getHeight());
 	_cursor->setX(x);
@@ -306,18 +341,21 @@ int StartState::load(void *game_ptr)
 	try
 	{
 		Log(LOG_INFO) << "Loading data...";
+		StartupProfiler::begin();
 		Options::updateMods();
 		game->loadMods();
 		Log(LOG_INFO) << "Data loaded successfully.";
 		Log(LOG_INFO) << "Loading language...";
 		game->loadLanguages();
 		Log(LOG_INFO) << "Language loaded successfully.";
+		StartupProfiler::end();
 		loading = LOADING_SUCCESSFUL;
 	}
 	catch (std::exception &e)
 	{
 		error = e.what();
 		Log(LOG_ERROR) << error;
+		StartupProfiler::end();
 		loading = LOADING_FAILED;
 	}
 
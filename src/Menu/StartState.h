@@ -46,6 +46,10 @@ private:
 
 	SDL_Thread *_thread;
 	std::ostringstream _output;
+	std::string _progress;
+
+	/// Shows terminal output and current progress.
+	void updateText();
 public:
 	static LoadingPhase loading;
 	static std::string error;
@@ -151,6 +151,14 @@ bool ExtraSprites::isLoaded() const
 	return _loaded;
 }
 
+/**
+ * Marks sprite as not loaded, after the surface or set made from it was deleted.
+ */
+void ExtraSprites::unload()
+{
+	_loaded = false;
+}
+
 /**
  * Determines if an image file is an acceptable format for the game.
  * @param filename Image filename.
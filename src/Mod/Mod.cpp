@@ -41,6 +41,7 @@
 #include "../Engine/Exception.h"
 #include "../Engine/Logger.h"
 #include "../Engine/ScriptBind.h"
+#include "../Engine/ScriptCache.h"
 #include "../Engine/Collections.h"
 #include "SoundDefinition.h"
 #include "ExtraSprites.h"
@@ -51,7 +52,11 @@
 #include "../fmath.h"
 #include "../Engine/RNG.h"
 #include "../Engine/Options.h"
+#include "../Engine/ThreadPool.h"
+#include "../Engine/ResourceLoader.h"
+#include "../Engine/StartupProfiler.h"
 #include "../Battlescape/Pathfinding.h"
+#include "RulesetCache.h"
 #include "RuleCountry.h"
 #include "RuleRegion.h"
 #include "RuleBaseFacility.h"
@@ -766,6 +771,35 @@ T *Mod::getRule(const std::string &id, const std::string &name, const std::map<s
 	}
 }
 
+/**
+ * Gets a specific rule element by ID.
+ * After loading ends, flat hash lookup is used instead of the map.
+ * @param id String ID of the rule element.
+ * @param name Human-readable name of the rule type.
+ * @param map Map associated to the rule type.
+ * @param lookup Fast lookup built from the map.
+ * @param error Throw an error if not found.
+ * @return Pointer to the rule element, or NULL if not found.
+ */
+template <typename T>
+T *Mod::getRule(const std::string &id, const std::string &name, const std::map<std::string, T*> &map, const RuleLookup<T> &lookup, bool error) const
+{
+	if (!lookup.isBuilt())
+	{
+		return getRule(id, name, map, error);
+	}
+	if (isEmptyRuleName(id))
+	{
+		return 0;
+	}
+	T *rule = lookup.find(id);
+	if (rule == 0 && error)
+	{
+		throw Exception(name + " " + id + " not found");
+	}
+	return rule;
+}
+
 /**
  * Returns a specific font from the mod.
  * @param name Name of the font.
@@ -792,6 +826,7 @@ void Mod::lazyLoadSurface(const std::string &name)
 			{
 				loadExtraSprite(*j);
 			}
+			_spriteResidency.touch(name);
 		}
 	}
 }
@@ -818,6 +853,48 @@ SurfaceSet *Mod::getSurfaceSet(const std::string &name, bool error)
 	return getRule(name, "Sprite Set", _sets, error);
 }
 
+/**
+ * Unloads sprite sets and surfaces loaded from extraSprites that no remaining state can use,
+ * least recently used first, until they fit in the memory budget.
+ * They are loaded again on next request. Called by the game when states were removed from the stack.
+ * @param depth Current size of state stack.
+ * @param lowDepth Lowest size of state stack in last cycle.
+ * @param reset Was whole state stack replaced?
+ */
+void Mod::trimSprites(size_t depth, size_t lowDepth, bool reset)
+{
+	size_t budget = 0;
+	if (Options::lazyLoadResources && Options::oxceSpriteMemoryBudget > 0)
+	{
+		budget = (size_t)Options::oxceSpriteMemoryBudget * 1024 * 1024;
+	}
+	auto names = _spriteResidency.trim(depth, lowDepth, reset, budget);
+	for (const auto& name : names)
+	{
+		auto set = _sets.find(name);
+		if (set != _sets.end())
+		{
+			delete set->second;
+			_sets.erase(set);
+		}
+		auto surface = _surfaces.find(name);
+		if (surface != _surfaces.end())
+		{
+			delete surface->second;
+			_surfaces.erase(surface);
+		}
+		for (auto* pack : _extraSprites[name])
+		{
+			pack->unload();
+		}
+		_spriteResidency.unloaded(name);
+	}
+	if (!names.empty())
+	{
+		Log(LOG_VERBOSE) << "Unloaded " << names.size() << " sprites, " << _spriteResidency.getResidentBytes() / 1024 << " KB of sprites still loaded.";
+	}
+}
+
 /**
  * Returns a specific music from the mod.
  * @param name Name of the music.
@@ -1892,6 +1969,7 @@ void Mod::loadKillCriteria(const std::string &parent, std::vector<std::vector<st
 template<typename T>
 static void afterLoadHelper(const char* name, Mod* mod, std::map<std::string, T*>& list, void (T::* func)(const Mod*))
 {
+	StartupProfiler::Scope profile("afterLoad", name);
 	std::ostringstream errorStream;
 	int errorLimit = 30;
 	int errorCount = 0;
@@ -1973,10 +2051,12 @@ static void throwModOnErrorHelper(const std::string& modId, const std::string& e
  */
 void Mod::loadAll()
 {
+	StartupProfiler::Scope profile("phase", "Mod::loadAll");
 	ModScript parser{ _scriptGlobal, this };
 	auto mods = FileMap::getRulesets();
 
 	Log(LOG_INFO) << "Loading begins...";
+	ResourceLoader::resetProgress();
 	if (Options::oxceModValidationLevel < LOG_ERROR)
 	{
 		Log(LOG_ERROR) << "Validation of mod data disabled, game can crash when run";
@@ -2023,6 +2103,7 @@ void Mod::loadAll()
 			auto* file = FileMap::getModRuleFile(_modCurrent->info, _modCurrent->info->getResourceConfigFile());
 			if (file)
 			{
+				StartupProfiler::Scope profileFile("rules", file->fullpath);
 				loadResourceConfigFile(*file);
 			}
 		}
@@ -2043,6 +2124,17 @@ void Mod::loadAll()
 	_soundOffsetGeo = _sounds["GEO.CAT"]->getMaxSharedSounds();
 
 	Log(LOG_INFO) << "Loading rulesets...";
+	RulesetCache cache(Options::getUserFolder() + "rulesets.cache");
+	if (Options::oxceRulesetCache)
+	{
+		cache.load();
+	}
+	if (Options::oxceScriptCache)
+	{
+		auto scriptCache = std::make_unique<ScriptCache>(Options::getUserFolder() + "scripts.cache", _scriptGlobal->getParserSignature());
+		scriptCache->load();
+		_scriptGlobal->setCache(std::move(scriptCache));
+	}
 	// load rest rulesets
 	for (size_t i = 0; mods.size() > i; ++i)
 	{
@@ -2050,7 +2142,7 @@ void Mod::loadAll()
 		{
 			_modCurrent = &_modData.at(i);
 			_scriptGlobal->setMod((int)_modCurrent->offset);
-			loadMod(mods[i].second, parser);
+			loadMod(mods[i].second, parser, Options::oxceRulesetCache ? &cache : nullptr);
 		}
 		catch (Exception &e)
 		{
@@ -2058,6 +2150,15 @@ void Mod::loadAll()
 			throwModOnErrorHelper(modId, e.what());
 		}
 	}
+	if (Options::oxceRulesetCache)
+	{
+		cache.save();
+	}
+	if (_scriptGlobal->getCache())
+	{
+		_scriptGlobal->getCache()->save();
+		_scriptGlobal->setCache(nullptr);
+	}
 	Log(LOG_INFO) << "Loading rulesets done.";
 
 	//back master
@@ -2201,6 +2302,16 @@ void Mod::loadAll()
 		}
 	}
 
+	// rule maps do not change after this point
+	_facilitiesLookup.build(_facilities);
+	_craftsLookup.build(_crafts);
+	_itemsLookup.build(_items);
+	_soldiersLookup.build(_soldiers);
+	_unitsLookup.build(_units);
+	_armorsLookup.build(_armors);
+	_researchLookup.build(_research);
+	_manufactureLookup.build(_manufacture);
+
 	// recommended user options
 	if (!_recommendedUserOptions.empty() && !Options::oxceRecommendedOptionsWereSet)
 	{
@@ -2262,24 +2373,121 @@ void Mod::loadAll()
  * mod loaded should be the master at index 0, then 1, and so on.
  * @param rulesetFiles List of rulesets to load.
  * @param parsers Object with all available parsers.
+ * @param cache Cache of parsed files, or null if not used.
  */
-void Mod::loadMod(const std::vector<FileMap::FileRecord> &rulesetFiles, ModScript &parsers)
+void Mod::loadMod(const std::vector<FileMap::FileRecord> &rulesetFiles, ModScript &parsers, RulesetCache *cache)
 {
-	for (auto i = rulesetFiles.begin(); i != rulesetFiles.end(); ++i)
+	StartupProfiler::Scope profile("mod", _modCurrent->name);
+	const size_t count = rulesetFiles.size();
+	std::vector<std::string> texts(count);
+	std::vector<std::string> keys(count);
+	std::vector<std::string> encoded(count);
+	std::vector<YAML::Node> docs(count);
+	std::vector<char> cached(count);
+	std::vector<std::exception_ptr> errors(count);
+
+	// files are read on main thread, zip archives can't be accessed from multiple threads
+	for (size_t i = 0; i < count; ++i)
 	{
-		Log(LOG_VERBOSE) << "- " << i->fullpath;
 		try
 		{
-			loadFile(*i, parsers);
+			StartupProfiler::Scope profileFile("read", rulesetFiles[i].fullpath);
+			auto stream = rulesetFiles[i].getIStream();
+			texts[i].assign(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+		}
+		catch (...)
+		{
+			errors[i] = std::current_exception();
+		}
+	}
+
+	// parsing do not depend on any rules, all files can be parsed at once
+	ThreadPool::getShared().parallelFor(count,
+		[&](size_t i, size_t worker)
+		{
+			if (!errors[i])
+			{
+				try
+				{
+					StartupProfiler::Scope profileFile("parse", rulesetFiles[i].fullpath);
+					// files with info tags need line numbers that cache do not have
+					if (cache && texts[i].find(InfoTag) == std::string::npos)
+					{
+						keys[i] = RulesetCache::getKey(texts[i]);
+						if (cache->find(keys[i], docs[i]))
+						{
+							cached[i] = true;
+						}
+						else
+						{
+							docs[i] = YAML::Load(texts[i]);
+							encoded[i] = RulesetCache::encode(docs[i]);
+						}
+					}
+					else
+					{
+						docs[i] = YAML::Load(texts[i]);
+					}
+				}
+				catch (...)
+				{
+					errors[i] = std::current_exception();
+				}
+			}
+			texts[i] = std::string();
+		}
+	);
+
+	// nodes from cache do not have line numbers, file is only parsed again without applying any rule to check its syntax,
+	// loading it again would apply part of it second time to this mod
+	auto getError = [&](size_t i, const std::string &error) -> std::string
+	{
+		if (!cached[i])
+		{
+			return error;
+		}
+		try
+		{
+			auto stream = rulesetFiles[i].getIStream();
+			std::string text(std::istreambuf_iterator<char>(*stream), {});
+			YAML::Load(text);
+		}
+		catch (YAML::Exception &e)
+		{
+			return e.what();
+		}
+		return error + " (file loaded from ruleset cache, line numbers are not available, disable oxceRulesetCache to see them)";
+	};
+
+	// rules are applied in same order as files are listed
+	for (size_t i = 0; i < count; ++i)
+	{
+		const auto& filerec = rulesetFiles[i];
+		Log(LOG_VERBOSE) << "- " << filerec.fullpath;
+		try
+		{
+			if (errors[i])
+			{
+				Log(LOG_FATAL) << "Error loading file '" << filerec.fullpath << "'";
+				std::rethrow_exception(errors[i]);
+			}
+			StartupProfiler::Scope profileFile("rules", filerec.fullpath);
+			loadFile(filerec, docs[i], parsers);
+			if (cache && !keys[i].empty())
+			{
+				// only files that loaded without errors are cached
+				cache->use(keys[i], std::move(encoded[i]));
+			}
 		}
 		catch (Exception &e)
 		{
-			throw Exception(i->fullpath + ": " + std::string(e.what()));
+			throw Exception(filerec.fullpath + ": " + getError(i, e.what()));
 		}
 		catch (YAML::Exception &e)
 		{
-			throw Exception(i->fullpath + ": " + std::string(e.what()));
+			throw Exception(filerec.fullpath + ": " + getError(i, e.what()));
 		}
+		docs[i] = YAML::Node();
 	}
 
 	// these need to be validated, otherwise we're gonna get into some serious trouble down the line.
@@ -2454,12 +2662,12 @@ void Mod::loadConstants(const YAML::Node &node)
 /**
  * Loads a ruleset's contents from a YAML file.
  * Rules that match pre-existing rules overwrite them.
- * @param filename YAML filename.
+ * @param filerec YAML file.
+ * @param doc Parsed content of file.
  * @param parsers Object with all available parsers.
  */
-void Mod::loadFile(const FileMap::FileRecord &filerec, ModScript &parsers)
+void Mod::loadFile(const FileMap::FileRecord &filerec, YAML::Node doc, ModScript &parsers)
 {
-	auto doc = filerec.getYAML();
 
 	if (const YAML::Node &extended = doc["extended"])
 	{
@@ -3559,7 +3767,7 @@ const std::vector<std::string> &Mod::getRegionsList() const
  */
 RuleBaseFacility *Mod::getBaseFacility(const std::string &id, bool error) const
 {
-	return getRule(id, "Facility", _facilities, error);
+	return getRule(id, "Facility", _facilities, _facilitiesLookup, error);
 }
 
 /**
@@ -3579,7 +3787,7 @@ const std::vector<std::string> &Mod::getBaseFacilitiesList() const
  */
 RuleCraft *Mod::getCraft(const std::string &id, bool error) const
 {
-	return getRule(id, "Craft", _crafts, error);
+	return getRule(id, "Craft", _crafts, _craftsLookup, error);
 }
 
 /**
@@ -3651,7 +3859,7 @@ RuleItem *Mod::getItem(const std::string &id, bool error) const
 	{
 		return 0;
 	}
-	return getRule(id, "Item", _items, error);
+	return getRule(id, "Item", _items, _itemsLookup, error);
 }
 
 /**
@@ -3741,7 +3949,7 @@ RuleSkill *Mod::getSkill(const std::string &name, bool error) const
  */
 RuleSoldier *Mod::getSoldier(const std::string &name, bool error) const
 {
-	return getRule(name, "Soldier", _soldiers, error);
+	return getRule(name, "Soldier", _soldiers, _soldiersLookup, error);
 }
 
 /**
@@ -3780,7 +3988,7 @@ const std::map<std::string, RuleCommendations *> &Mod::getCommendationsList() co
  */
 Unit *Mod::getUnit(const std::string &name, bool error) const
 {
-	return getRule(name, "Unit", _units, error);
+	return getRule(name, "Unit", _units, _unitsLookup, error);
 }
 
 /**
@@ -3873,7 +4081,7 @@ const std::vector<std::string> &Mod::getDeploymentsList() const
  */
 Armor *Mod::getArmor(const std::string &name, bool error) const
 {
-	return getRule(name, "Armor", _armors, error);
+	return getRule(name, "Armor", _armors, _armorsLookup, error);
 }
 
 /**
@@ -4042,7 +4250,7 @@ const std::vector<std::string> &Mod::getInvsList() const
  */
 RuleResearch *Mod::getResearch(const std::string &id, bool error) const
 {
-	return getRule(id, "Research", _research, error);
+	return getRule(id, "Research", _research, _researchLookup, error);
 }
 
 /**
@@ -4091,7 +4299,7 @@ const std::vector<std::string> &Mod::getResearchList() const
  */
 RuleManufacture *Mod::getManufacture (const std::string &id, bool error) const
 {
-	return getRule(id, "Manufacture", _manufacture, error);
+	return getRule(id, "Manufacture", _manufacture, _manufactureLookup, error);
 }
 
 /**
@@ -4481,6 +4689,7 @@ struct compareSection
  */
 void Mod::sortLists()
 {
+	StartupProfiler::Scope profile("phase", "sortLists");
 	for (auto& rulePair : _ufopaediaArticles)
 	{
 		auto* rule = rulePair.second;
@@ -4887,6 +5096,7 @@ namespace
  */
 void Mod::loadVanillaResources()
 {
+	StartupProfiler::Scope profile("phase", "loadVanillaResources");
 	// Create Geoscape surface
 	_sets["GlobeMarkers"] = new SurfaceSet(3, 3);
 	// dummy resources, that need to be defined in order for mod loading to work correctly
@@ -4982,6 +5192,7 @@ void Mod::loadVanillaResources()
 		"INTICON.PCK",
 		"TEXTURE.DAT" };
 
+	ResourceLoader loader;
 	for (size_t i = 0; i < ARRAYLEN(sets); ++i)
 	{
 		std::ostringstream s;
@@ -4993,21 +5204,15 @@ void Mod::loadVanillaResources()
 			std::string tab = CrossPlatform::noExt(sets[i]) + ".TAB";
 			std::ostringstream s2;
 			s2 << "GEOGRAPH/" << tab;
-			_sets[sets[i]] = new SurfaceSet(32, 40);
-			_sets[sets[i]]->loadPck(s.str(), s2.str());
+			loader.addPck(sets[i], new SurfaceSet(32, 40), s.str(), s2.str());
 		}
 		else
 		{
-			_sets[sets[i]] = new SurfaceSet(32, 32);
-			_sets[sets[i]]->loadDat(s.str());
+			loader.addDat(sets[i], new SurfaceSet(32, 32), s.str());
 		}
 	}
-	{
-		std::string s1 = "GEODATA/SCANG.DAT";
-		std::string s2 = "SCANG.DAT";
-		_sets[s2] = new SurfaceSet(4, 4);
-		_sets[s2]->loadDat(s1);
-	}
+	loader.addDat("SCANG.DAT", new SurfaceSet(4, 4), "GEODATA/SCANG.DAT");
+	loader.run(_sets);
 
 	// construct sound sets
 	_sounds["GEO.CAT"] = new SoundSet();
@@ -5189,27 +5394,22 @@ void Mod::loadVanillaResources()
  */
 void Mod::loadBattlescapeResources()
 {
+	// all sets are decoded at once
+	ResourceLoader loader;
+
 	// Load Battlescape ICONS
-	_sets["SPICONS.DAT"] = new SurfaceSet(32, 24);
-	_sets["SPICONS.DAT"]->loadDat("UFOGRAPH/SPICONS.DAT");
-	_sets["CURSOR.PCK"] = new SurfaceSet(32, 40);
-	_sets["CURSOR.PCK"]->loadPck("UFOGRAPH/CURSOR.PCK", "UFOGRAPH/CURSOR.TAB");
-	_sets["SMOKE.PCK"] = new SurfaceSet(32, 40);
-	_sets["SMOKE.PCK"]->loadPck("UFOGRAPH/SMOKE.PCK", "UFOGRAPH/SMOKE.TAB");
-	_sets["HIT.PCK"] = new SurfaceSet(32, 40);
-	_sets["HIT.PCK"]->loadPck("UFOGRAPH/HIT.PCK", "UFOGRAPH/HIT.TAB");
-	_sets["X1.PCK"] = new SurfaceSet(128, 64);
-	_sets["X1.PCK"]->loadPck("UFOGRAPH/X1.PCK", "UFOGRAPH/X1.TAB");
-	_sets["MEDIBITS.DAT"] = new SurfaceSet(52, 58);
-	_sets["MEDIBITS.DAT"]->loadDat("UFOGRAPH/MEDIBITS.DAT");
-	_sets["DETBLOB.DAT"] = new SurfaceSet(16, 16);
-	_sets["DETBLOB.DAT"]->loadDat("UFOGRAPH/DETBLOB.DAT");
+	loader.addDat("SPICONS.DAT", new SurfaceSet(32, 24), "UFOGRAPH/SPICONS.DAT");
+	loader.addPck("CURSOR.PCK", new SurfaceSet(32, 40), "UFOGRAPH/CURSOR.PCK", "UFOGRAPH/CURSOR.TAB");
+	loader.addPck("SMOKE.PCK", new SurfaceSet(32, 40), "UFOGRAPH/SMOKE.PCK", "UFOGRAPH/SMOKE.TAB");
+	loader.addPck("HIT.PCK", new SurfaceSet(32, 40), "UFOGRAPH/HIT.PCK", "UFOGRAPH/HIT.TAB");
+	loader.addPck("X1.PCK", new SurfaceSet(128, 64), "UFOGRAPH/X1.PCK", "UFOGRAPH/X1.TAB");
+	loader.addDat("MEDIBITS.DAT", new SurfaceSet(52, 58), "UFOGRAPH/MEDIBITS.DAT");
+	loader.addDat("DETBLOB.DAT", new SurfaceSet(16, 16), "UFOGRAPH/DETBLOB.DAT");
 	_sets["Projectiles"] = new SurfaceSet(3, 3);
 	_sets["UnderwaterProjectiles"] = new SurfaceSet(3, 3);
 
 	// Load Battlescape Terrain (only blanks are loaded, others are loaded just in time)
-	_sets["BLANKS.PCK"] = new SurfaceSet(32, 40);
-	_sets["BLANKS.PCK"]->loadPck("TERRAIN/BLANKS.PCK", "TERRAIN/BLANKS.TAB");
+	loader.addPck("BLANKS.PCK", new SurfaceSet(32, 40), "TERRAIN/BLANKS.PCK", "TERRAIN/BLANKS.TAB");
 
 	// Load Battlescape units
 	auto unitsContents = FileMap::getVFolderContents("UNITS");
@@ -5218,12 +5418,14 @@ void Mod::loadBattlescapeResources()
 	{
 		std::string fname = *i;
 		std::transform(i->begin(), i->end(), fname.begin(), toupper);
+		SurfaceSet *set;
 		if (fname != "BIGOBS.PCK")
-			_sets[fname] = new SurfaceSet(32, 40);
+			set = new SurfaceSet(32, 40);
 		else
-			_sets[fname] = new SurfaceSet(32, 48);
-		_sets[fname]->loadPck("UNITS/" + *i, "UNITS/" + CrossPlatform::noExt(*i) + ".TAB");
+			set = new SurfaceSet(32, 48);
+		loader.addPck(fname, set, "UNITS/" + *i, "UNITS/" + CrossPlatform::noExt(*i) + ".TAB");
 	}
+	loader.run(_sets);
 	// incomplete chryssalid set: 1.0 data: stop loading.
 	if (_sets.find("CHRYS.PCK") != _sets.end() && !_sets["CHRYS.PCK"]->getFrame(225))
 	{
@@ -5479,6 +5681,7 @@ void Mod::loadBattlescapeResources()
  */
 void Mod::loadExtraResources()
 {
+	StartupProfiler::Scope profile("phase", "loadExtraResources");
 	// Load fonts
 	YAML::Node doc = FileMap::getYAML("Language/" + _fontName);
 	Log(LOG_INFO) << "Loading fonts... " << _fontName;
@@ -5658,6 +5861,10 @@ void Mod::loadExtraSprite(ExtraSprites *spritePack)
 	if (spritePack->isLoaded())
 		return;
 
+	// only sprites that don't extend vanilla ones can be loaded again after unloading
+	bool evictable = _surfaces.find(spritePack->getType()) == _surfaces.end() && _sets.find(spritePack->getType()) == _sets.end();
+	size_t bytes = 0;
+
 	if (spritePack->getSingleImage())
 	{
 		Surface *surface = 0;
@@ -5675,6 +5882,8 @@ void Mod::loadExtraSprite(ExtraSprites *spritePack)
 				_surfaces[spritePack->getType()]->setPalette(_statePalette);
 			}
 		}
+		Surface *loaded = _surfaces[spritePack->getType()];
+		bytes = (size_t)loaded->getPitch() * loaded->getHeight();
 	}
 	else
 	{
@@ -5693,7 +5902,10 @@ void Mod::loadExtraSprite(ExtraSprites *spritePack)
 				_sets[spritePack->getType()]->setPalette(_statePalette);
 			}
 		}
+		SurfaceSet *loaded = _sets[spritePack->getType()];
+		bytes = loaded->getTotalFrames() * loaded->getWidth() * loaded->getHeight();
 	}
+	_spriteResidency.loaded(spritePack->getType(), bytes, evictable);
 }
 
 /**
@@ -5701,6 +5913,7 @@ void Mod::loadExtraSprite(ExtraSprites *spritePack)
  */
 void Mod::modResources()
 {
+	StartupProfiler::Scope profile("phase", "modResources");
 	// we're gonna need these
 	getSurface("GEOBORD.SCR");
 	getSurface("ALTGEOBORD.SCR", false);
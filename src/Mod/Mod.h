@@ -31,6 +31,8 @@
 #include "RuleAlienMission.h"
 #include "RuleBaseFacilityFunctions.h"
 #include "RuleItem.h"
+#include "RuleLookup.h"
+#include "SpriteResidency.h"
 
 namespace OpenXcom
 {
@@ -100,6 +102,7 @@ class ModScript;
 class ModScriptGlobal;
 class ScriptParserBase;
 class ScriptGlobal;
+class RulesetCache;
 struct StatAdjustment;
 
 enum GameDifficulty : int;
@@ -201,6 +204,16 @@ private:
 	std::vector<RuleDamageType*> _damageTypes;
 	std::map<std::string, RuleMusic *> _musicDefs;
 
+	/// Fast lookups of most used rules, built when loading ends.
+	RuleLookup<RuleBaseFacility> _facilitiesLookup;
+	RuleLookup<RuleCraft> _craftsLookup;
+	RuleLookup<RuleItem> _itemsLookup;
+	RuleLookup<RuleSoldier> _soldiersLookup;
+	RuleLookup<Unit> _unitsLookup;
+	RuleLookup<Armor> _armorsLookup;
+	RuleLookup<RuleResearch> _researchLookup;
+	RuleLookup<RuleManufacture> _manufactureLookup;
+
 	RuleGlobe *_globe;
 	RuleConverter *_converter;
 	ModScriptGlobal *_scriptGlobal;
@@ -297,6 +310,7 @@ private:
 	std::vector<ModData> _modData;
 	ModData* _modCurrent;
 	const SDL_Color *_statePalette;
+	SpriteResidency _spriteResidency;
 
 	std::vector<std::string> _psiRequirements; // it's a cache for psiStrengthEval
 	std::vector<const Armor*> _armorsForSoldiersCache;
@@ -315,14 +329,17 @@ private:
 	/// Loads a ruleset from a YAML file that have basic resources configuration.
 	void loadResourceConfigFile(const FileMap::FileRecord &filerec);
 	void loadConstants(const YAML::Node &node);
-	/// Loads a ruleset from a YAML file.
-	void loadFile(const FileMap::FileRecord &filerec, ModScript &parsers);
+	/// Loads a ruleset from a parsed YAML file.
+	void loadFile(const FileMap::FileRecord &filerec, YAML::Node doc, ModScript &parsers);
 	/// Loads a ruleset element.
 	template <typename T>
 	T *loadRule(const YAML::Node &node, std::map<std::string, T*> *map, std::vector<std::string> *index = 0, const std::string &key = "type") const;
 	/// Gets a ruleset element.
 	template <typename T>
 	T *getRule(const std::string &id, const std::string &name, const std::map<std::string, T*> &map, bool error) const;
+	/// Gets a ruleset element, using fast lookup if available.
+	template <typename T>
+	T *getRule(const std::string &id, const std::string &name, const std::map<std::string, T*> &map, const RuleLookup<T> &lookup, bool error) const;
 	/// Gets a random music. This is private to prevent access, use playMusic(name, true) instead.
 	Music *getRandomMusic(const std::string &name) const;
 	/// Gets a particular sound set. This is private to prevent access, use getSound(name, id) instead.
@@ -334,7 +351,7 @@ private:
 	/// Creates a transparency lookup table for a given palette.
 	void createTransparencyLUT(Palette *pal);
 	/// Loads a specified mod content.
-	void loadMod(const std::vector<FileMap::FileRecord> &rulesetFiles, ModScript &parsers);
+	void loadMod(const std::vector<FileMap::FileRecord> &rulesetFiles, ModScript &parsers, RulesetCache *cache);
 	/// Loads resources from vanilla.
 	void loadVanillaResources();
 	/// Loads resources from extra rulesets.
@@ -427,6 +444,10 @@ public:
 	Surface *getSurface(const std::string &name, bool error = true);
 	/// Gets a particular surface set.
 	SurfaceSet *getSurfaceSet(const std::string &name, bool error = true);
+	/// Unloads sprites that no state uses, if they are over the memory budget.
+	void trimSprites(size_t depth, size_t lowDepth, bool reset);
+	/// Gets memory used by sprites loaded from extraSprites.
+	const SpriteResidency &getSpriteResidency() const { return _spriteResidency; }
 	/// Gets a particular music.
 	Music *getMusic(const std::string &name, bool error = true) const;
 	/// Gets the available music tracks.
@@ -0,0 +1,104 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <map>
+#include <string>
+#include <vector>
+#include <functional>
+
+namespace OpenXcom
+{
+
+/**
+ * Flat hash table of rules by name, used for fast lookups once all rules are loaded.
+ * Names are not copied, table points to keys of the rule map, so map must not change after table is built.
+ */
+template<typename T>
+class RuleLookup
+{
+	/// One slot of hash table.
+	struct Entry
+	{
+		size_t hash;
+		const std::string *name;
+		T *rule;
+	};
+
+	std::vector<Entry> _table;
+	size_t _mask = 0;
+
+public:
+	/// Builds table for all rules in map.
+	void build(const std::map<std::string, T*> &map)
+	{
+		size_t size = 16;
+		while (size < map.size() * 2)
+		{
+			size *= 2;
+		}
+		_table.assign(size, Entry{ 0, nullptr, nullptr });
+		_mask = size - 1;
+
+		for (const auto& p : map)
+		{
+			if (p.second == nullptr)
+			{
+				continue;
+			}
+			size_t hash = std::hash<std::string>{}(p.first);
+			size_t i = hash & _mask;
+			while (_table[i].name)
+			{
+				i = (i + 1) & _mask;
+			}
+			_table[i] = Entry{ hash, &p.first, p.second };
+		}
+	}
+
+	/// Removes all entries, lookups need to use rule map again.
+	void clear()
+	{
+		_table.clear();
+		_mask = 0;
+	}
+
+	/// Was table built?
+	bool isBuilt() const
+	{
+		return !_table.empty();
+	}
+
+	/// Finds rule by name, return null if there is no such rule.
+	T *find(const std::string &name) const
+	{
+		size_t hash = std::hash<std::string>{}(name);
+		size_t i = hash & _mask;
+		while (_table[i].name)
+		{
+			if (_table[i].hash == hash && *_table[i].name == name)
+			{
+				return _table[i].rule;
+			}
+			i = (i + 1) & _mask;
+		}
+		return nullptr;
+	}
+};
+
+}
@@ -0,0 +1,363 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RulesetCache.h"
+#include <SDL.h>
+#include "../Engine/CrossPlatform.h"
+#include "../Engine/Exception.h"
+#include "../Engine/Logger.h"
+#include "../Engine/SDL2Helpers.h"
+#include "../Engine/StartupProfiler.h"
+#include "../md5.h"
+#include "../version.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+/// Header of cache file, change of format or engine version invalidates whole cache.
+const std::string CacheHeader = std::string("OXCE ruleset cache 1 ") + OPENXCOM_VERSION_ENGINE + OPENXCOM_VERSION_GIT;
+
+/// Kinds of nodes stored in cache.
+enum CacheNodeType : Uint8 { CNT_NULL, CNT_SCALAR, CNT_SEQUENCE, CNT_MAP };
+
+void writeSize(std::string &out, size_t size)
+{
+	do
+	{
+		Uint8 b = size & 0x7F;
+		size >>= 7;
+		out.push_back((char)(size ? b | 0x80 : b));
+	} while (size);
+}
+
+void writeString(std::string &out, const std::string &str)
+{
+	writeSize(out, str.size());
+	out.append(str);
+}
+
+void writeNode(std::string &out, const YAML::Node &node)
+{
+	switch (node.Type())
+	{
+	case YAML::NodeType::Scalar:
+		out.push_back((char)CNT_SCALAR);
+		break;
+	case YAML::NodeType::Sequence:
+		out.push_back((char)CNT_SEQUENCE);
+		break;
+	case YAML::NodeType::Map:
+		out.push_back((char)CNT_MAP);
+		break;
+	default:
+		out.push_back((char)CNT_NULL);
+		break;
+	}
+	out.push_back((char)node.Style());
+	writeString(out, node.Tag());
+
+	switch (node.Type())
+	{
+	case YAML::NodeType::Scalar:
+		writeString(out, node.Scalar());
+		break;
+	case YAML::NodeType::Sequence:
+		writeSize(out, node.size());
+		for (const YAML::Node &n : node)
+		{
+			writeNode(out, n);
+		}
+		break;
+	case YAML::NodeType::Map:
+		writeSize(out, node.size());
+		for (YAML::const_iterator i = node.begin(); i != node.end(); ++i)
+		{
+			writeNode(out, i->first);
+			writeNode(out, i->second);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * Reads data written by functions above, throws on truncated or corrupted data.
+ */
+struct CacheReader
+{
+	const char *curr;
+	const char *end;
+
+	Uint8 readByte()
+	{
+		if (curr == end)
+		{
+			throw Exception("Unexpected end of ruleset cache");
+		}
+		return (Uint8)*curr++;
+	}
+
+	size_t readSize()
+	{
+		size_t size = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			Uint8 b = readByte();
+			size |= (size_t)(b & 0x7F) << shift;
+			if ((b & 0x80) == 0)
+			{
+				return size;
+			}
+		}
+		throw Exception("Invalid size in ruleset cache");
+	}
+
+	std::string readString()
+	{
+		size_t size = readSize();
+		if (size > (size_t)(end - curr))
+		{
+			throw Exception("Unexpected end of ruleset cache");
+		}
+		std::string str(curr, size);
+		curr += size;
+		return str;
+	}
+
+	YAML::Node readNode()
+	{
+		Uint8 type = readByte();
+		Uint8 style = readByte();
+		std::string tag = readString();
+
+		YAML::Node node;
+		switch (type)
+		{
+		case CNT_NULL:
+			node = YAML::Node(YAML::NodeType::Null);
+			break;
+		case CNT_SCALAR:
+			node = YAML::Node(readString());
+			break;
+		case CNT_SEQUENCE:
+		{
+			node = YAML::Node(YAML::NodeType::Sequence);
+			size_t size = readSize();
+			for (size_t i = 0; i < size; ++i)
+			{
+				node.push_back(readNode());
+			}
+			break;
+		}
+		case CNT_MAP:
+		{
+			node = YAML::Node(YAML::NodeType::Map);
+			size_t size = readSize();
+			for (size_t i = 0; i < size; ++i)
+			{
+				YAML::Node key = readNode();
+				YAML::Node value = readNode();
+				// keep duplicate keys same as parser do
+				node.force_insert(key, value);
+			}
+			break;
+		}
+		default:
+			throw Exception("Invalid node in ruleset cache");
+		}
+		node.SetTag(tag);
+		node.SetStyle((YAML::EmitterStyle::value)style);
+		return node;
+	}
+};
+
+} // namespace
+
+/**
+ * Creates empty cache.
+ * @param path Full path of cache file.
+ */
+RulesetCache::RulesetCache(const std::string &path) : _path(path), _changed(false)
+{
+}
+
+/**
+ * Cleans up the cache.
+ */
+RulesetCache::~RulesetCache()
+{
+}
+
+/**
+ * Reads all entries from cache file.
+ * Missing, outdated or broken file is ignored, cache is then rebuilt from scratch.
+ */
+void RulesetCache::load()
+{
+	StartupProfiler::Scope profile("phase", "RulesetCache::load");
+	_entries.clear();
+	_used.clear();
+	_changed = false;
+
+	if (!CrossPlatform::fileExists(_path))
+	{
+		_changed = true;
+		return;
+	}
+
+	SDL_RWops *rwops = SDL_RWFromFile(_path.c_str(), "rb");
+	if (!rwops)
+	{
+		_changed = true;
+		return;
+	}
+	size_t size = 0;
+	char *data = (char *)SDL_LoadFile_RW(rwops, &size, SDL_TRUE);
+	if (!data)
+	{
+		_changed = true;
+		return;
+	}
+
+	try
+	{
+		CacheReader reader{ data, data + size };
+		if (reader.readString() != CacheHeader)
+		{
+			throw Exception("Ruleset cache version changed");
+		}
+		size_t count = reader.readSize();
+		for (size_t i = 0; i < count; ++i)
+		{
+			std::string key = reader.readString();
+			_entries[key] = reader.readString();
+		}
+		Log(LOG_VERBOSE) << "Ruleset cache: " << _entries.size() << " entries loaded";
+	}
+	catch (Exception &e)
+	{
+		Log(LOG_INFO) << "Ruleset cache ignored: " << e.what();
+		_entries.clear();
+		_changed = true;
+	}
+	SDL_free(data);
+}
+
+/**
+ * Writes entries used in this run to cache file.
+ * Entries of files that were changed or removed are dropped.
+ */
+void RulesetCache::save()
+{
+	StartupProfiler::Scope profile("phase", "RulesetCache::save");
+	if (!_changed && _used.size() == _entries.size())
+	{
+		return;
+	}
+
+	std::string out;
+	writeString(out, CacheHeader);
+	writeSize(out, _used.size());
+	for (const auto& p : _used)
+	{
+		writeString(out, p.first);
+		writeString(out, p.second);
+	}
+	if (CrossPlatform::writeFile(_path, out))
+	{
+		Log(LOG_VERBOSE) << "Ruleset cache: " << _used.size() << " entries saved";
+	}
+	_changed = false;
+}
+
+/**
+ * Calculates key of ruleset file.
+ * @param text Content of file.
+ * @return MD5 hash of content.
+ */
+std::string RulesetCache::getKey(const std::string &text)
+{
+	MD5 md5;
+	md5.update(text.data(), text.size());
+	md5.finalize();
+	return md5.hexdigest();
+}
+
+/**
+ * Converts parsed ruleset file to data stored in cache.
+ * @param node Root node of file.
+ * @return Binary data.
+ */
+std::string RulesetCache::encode(const YAML::Node &node)
+{
+	std::string out;
+	writeNode(out, node);
+	return out;
+}
+
+/**
+ * Finds cached ruleset file.
+ * Only reads data loaded from disk, so can be called from worker threads.
+ * @param key Key of file content.
+ * @param doc Restored root node of file.
+ * @return True if file was found in cache.
+ */
+bool RulesetCache::find(const std::string &key, YAML::Node &doc) const
+{
+	auto it = _entries.find(key);
+	if (it == _entries.end())
+	{
+		return false;
+	}
+	try
+	{
+		CacheReader reader{ it->second.data(), it->second.data() + it->second.size() };
+		doc = reader.readNode();
+		return reader.curr == reader.end;
+	}
+	catch (Exception &)
+	{
+		return false;
+	}
+}
+
+/**
+ * Marks entry as used, it will be kept in cache file.
+ * @param key Key of file content.
+ * @param data Binary data of new entry, or empty if entry was found in cache.
+ */
+void RulesetCache::use(const std::string &key, std::string &&data)
+{
+	if (data.empty())
+	{
+		auto it = _entries.find(key);
+		if (it != _entries.end())
+		{
+			_used[key] = it->second;
+		}
+		return;
+	}
+	_used[key] = std::move(data);
+	_changed = true;
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <unordered_map>
+#include <yaml-cpp/yaml.h>
+
+namespace OpenXcom
+{
+
+/**
+ * On disk cache of parsed ruleset files.
+ * Each file is stored as compact binary copy of its YAML tree, keyed by MD5 hash of file content,
+ * so changed files are simply parsed again and no other invalidation is needed.
+ * Positions of nodes in original file are not stored, errors in cached files report unknown line.
+ */
+class RulesetCache
+{
+private:
+	std::string _path;
+	/// Entries read from disk.
+	std::unordered_map<std::string, std::string> _entries;
+	/// Entries used in this run, only these are written back.
+	std::unordered_map<std::string, std::string> _used;
+	bool _changed;
+
+public:
+	/// Creates empty cache stored in given file.
+	RulesetCache(const std::string &path);
+	/// Cleans up the cache.
+	~RulesetCache();
+	/// Reads cache file, if it exists and match current version.
+	void load();
+	/// Writes used entries to cache file, if anything changed.
+	void save();
+	/// Calculates key of file content.
+	static std::string getKey(const std::string &text);
+	/// Converts YAML tree to binary data.
+	static std::string encode(const YAML::Node &node);
+	/// Finds cached tree of file, safe to call from multiple threads.
+	bool find(const std::string &key, YAML::Node &doc) const;
+	/// Marks entry as used in this run, adding it if it's new.
+	void use(const std::string &key, std::string &&data);
+};
+
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SpriteResidency.h"
+#include <algorithm>
+
+namespace OpenXcom
+{
+
+std::atomic<uint64_t> SpriteResidency::_tick{ 0 };
+std::atomic<uint64_t> SpriteResidency::_cycleTick{ 0 };
+std::atomic<size_t> SpriteResidency::_activeDepth{ 0 };
+
+/**
+ * Creates empty tracker.
+ */
+SpriteResidency::SpriteResidency() : _residentBytes(0)
+{
+}
+
+/**
+ * Cleans up the tracker.
+ */
+SpriteResidency::~SpriteResidency()
+{
+}
+
+/**
+ * Sets depth of state that currently handles events, thinks or draws.
+ * States created now will be pushed at this depth or above it.
+ * @param depth Position in state stack, counting from 1.
+ */
+void SpriteResidency::setActiveDepth(size_t depth)
+{
+	_activeDepth = depth;
+}
+
+/**
+ * Marks start of new game cycle, sprites used from now on can be used by states created in this cycle.
+ */
+void SpriteResidency::beginCycle()
+{
+	_cycleTick = _tick.load();
+}
+
+/**
+ * Records sprite that was loaded, or extended by next pack of same type.
+ * @param name Type of sprite.
+ * @param bytes Current size of sprite.
+ * @param evictable Can be unloaded and loaded again (used only for new entry).
+ */
+void SpriteResidency::loaded(const std::string &name, size_t bytes, bool evictable)
+{
+	auto it = _entries.find(name);
+	if (it == _entries.end())
+	{
+		it = _entries.insert(std::make_pair(name, Entry{ 0, 0, SIZE_MAX, evictable })).first;
+	}
+	_residentBytes = _residentBytes - it->second.bytes + bytes;
+	it->second.bytes = bytes;
+	touch(name);
+}
+
+/**
+ * Marks sprite as used by current state.
+ * @param name Type of sprite.
+ */
+void SpriteResidency::touch(const std::string &name)
+{
+	auto it = _entries.find(name);
+	if (it != _entries.end())
+	{
+		it->second.lastUse = ++_tick;
+		it->second.minDepth = std::min(it->second.minDepth, _activeDepth.load());
+	}
+}
+
+/**
+ * Forgets sprite that was unloaded.
+ * @param name Type of sprite.
+ */
+void SpriteResidency::unloaded(const std::string &name)
+{
+	auto it = _entries.find(name);
+	if (it != _entries.end())
+	{
+		_residentBytes -= it->second.bytes;
+		_entries.erase(it);
+	}
+}
+
+/**
+ * Gets sprites that should be unloaded to fit in budget, least recently used first.
+ * Only sprites not used from any remaining state are picked.
+ * States created in last cycle are above `lowDepth`, but sprites they used were marked
+ * with depth of state that created them, so sprites used in last cycle are moved down to it.
+ * @param depth Current size of state stack.
+ * @param lowDepth Lowest size of state stack in last cycle.
+ * @param reset Was whole stack replaced? Only states created in last cycle remain then.
+ * @param budget Memory budget in bytes, 0 for unlimited.
+ * @return Names of sprites to unload.
+ */
+std::vector<std::string> SpriteResidency::trim(size_t depth, size_t lowDepth, bool reset, size_t budget)
+{
+	const uint64_t cycleTick = _cycleTick;
+	for (auto& p : _entries)
+	{
+		if (reset)
+		{
+			p.second.minDepth = p.second.lastUse > cycleTick ? 0 : SIZE_MAX;
+		}
+		else if (p.second.lastUse > cycleTick)
+		{
+			p.second.minDepth = std::min(p.second.minDepth, lowDepth + 1);
+		}
+	}
+
+	std::vector<std::string> names;
+	if (budget == 0 || _residentBytes <= budget)
+	{
+		return names;
+	}
+
+	std::vector<std::pair<uint64_t, const std::string*>> candidates;
+	for (const auto& p : _entries)
+	{
+		if (p.second.evictable && p.second.minDepth > depth)
+		{
+			candidates.push_back(std::make_pair(p.second.lastUse, &p.first));
+		}
+	}
+	std::sort(candidates.begin(), candidates.end());
+
+	size_t resident = _residentBytes;
+	for (const auto& c : candidates)
+	{
+		if (resident <= budget)
+		{
+			break;
+		}
+		resident -= _entries.at(*c.second).bytes;
+		names.push_back(*c.second);
+	}
+	return names;
+}
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace OpenXcom
+{
+
+/**
+ * Tracks memory used by sprites loaded from extraSprites and picks ones to unload when they are over budget.
+ * States keep plain pointers to sprites, so each sprite remembers lowest depth of the state stack it was used from.
+ * When stack shrinks below that depth, no remaining state can point to it and it can be unloaded.
+ */
+class SpriteResidency
+{
+public:
+	/// Memory used by one sprite or sprite set.
+	struct Entry
+	{
+		size_t bytes;
+		uint64_t lastUse;
+		size_t minDepth;
+		bool evictable;
+	};
+
+private:
+	std::unordered_map<std::string, Entry> _entries;
+	size_t _residentBytes;
+
+	static std::atomic<uint64_t> _tick;
+	static std::atomic<uint64_t> _cycleTick;
+	static std::atomic<size_t> _activeDepth;
+
+public:
+	/// Creates empty tracker.
+	SpriteResidency();
+	/// Cleans up the tracker.
+	~SpriteResidency();
+
+	/// Sets depth of state that currently runs.
+	static void setActiveDepth(size_t depth);
+	/// Marks start of new game cycle.
+	static void beginCycle();
+
+	/// Records sprite that was loaded or extended.
+	void loaded(const std::string &name, size_t bytes, bool evictable);
+	/// Marks sprite as used by current state.
+	void touch(const std::string &name);
+	/// Forgets sprite that was unloaded.
+	void unloaded(const std::string &name);
+	/// Gets sprites that should be unloaded.
+	std::vector<std::string> trim(size_t depth, size_t lowDepth, bool reset, size_t budget);
+
+	/// Gets memory used by all tracked sprites.
+	size_t getResidentBytes() const { return _residentBytes; }
+	/// Gets all tracked sprites.
+	const std::unordered_map<std::string, Entry> &getEntries() const { return _entries; }
+};
+
+}
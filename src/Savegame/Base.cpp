@@ -556,6 +556,24 @@ UfoDetection Base::detect(const Ufo *target, const SavedGame *save, bool already
 	return RNG::percent(args.getSecond()) ? (UfoDetection)args.getFirst() : DETECTION_NONE;
 }
 
+/**
+ * Returns the longest range of radars in the base,
+ * targets farther away can't be detected by any base facility.
+ * @return Range in XCOM units.
+ */
+int Base::getMaxRadarRange() const
+{
+	int range = 0;
+	for (const auto* fac : _facilities)
+	{
+		if (fac->getBuildTime() == 0)
+		{
+			range = std::max(range, fac->getRules()->getRadarRange());
+		}
+	}
+	return range;
+}
+
 /**
  * Returns the amount of soldiers contained
  * in the base without any assignments.
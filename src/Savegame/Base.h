@@ -154,6 +154,8 @@ public:
 	void setEngineers(int engineers);
 	/// Checks if a target is detected by the base's radar.
 	UfoDetection detect(const Ufo *target, const SavedGame *save, bool alreadyTracked) const;
+	/// Gets the longest radar range of the base's finished facilities.
+	int getMaxRadarRange() const;
 	/// Gets the base's available soldiers.
 	int getAvailableSoldiers(bool checkCombatReadiness = false, bool includeWounded = false) const;
 	/// Gets the base's total soldiers.
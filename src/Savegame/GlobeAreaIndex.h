@@ -0,0 +1,168 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include "../fmath.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Grid over the globe with areas of regions or countries that touch each cell.
+ * Finding object at a point only checks areas in one cell instead of all areas of all objects,
+ * result is same as checking `insideRegion`/`insideCountry` of each object in list order.
+ * Objects need `getRules()` with area lists, list of objects must not change after grid is built,
+ * except adding new ones at end, which is detected by `isBuilt`.
+ */
+template<typename T>
+class GlobeAreaIndex
+{
+	/// One area of object.
+	struct Area
+	{
+		double lonMin, lonMax, latMin, latMax;
+		T *object;
+	};
+
+	static constexpr int CellsLon = 180;
+	static constexpr int CellsLat = 90;
+
+	/// Areas sorted by cell, in order of objects.
+	std::vector<Area> _areas;
+	/// Index of first area of each cell in `_areas`, with one extra at end.
+	std::vector<unsigned> _cells;
+	/// Number of objects in grid.
+	size_t _size = 0;
+
+	/// Gets cell column of longitude, values out of range go to first or last cell.
+	static int cellLon(double lon)
+	{
+		double c = lon * (CellsLon / (2 * M_PI));
+		if (!(c > 0))
+		{
+			return 0;
+		}
+		return c < CellsLon - 1 ? (int)c : CellsLon - 1;
+	}
+
+	/// Gets cell row of latitude, values out of range go to first or last cell.
+	static int cellLat(double lat)
+	{
+		double c = (lat + M_PI_2) * (CellsLat / M_PI);
+		if (!(c > 0))
+		{
+			return 0;
+		}
+		return c < CellsLat - 1 ? (int)c : CellsLat - 1;
+	}
+
+	/// Calls function for each cell that area can contain points of, same conditions as `RuleRegion::insideRegion`.
+	template<typename F>
+	static void forEachCell(const Area &area, F &&f)
+	{
+		auto rows = [&](int lonBegin, int lonEnd)
+		{
+			for (int y = cellLat(area.latMin); y <= cellLat(area.latMax); ++y)
+			{
+				for (int x = lonBegin; x <= lonEnd; ++x)
+				{
+					f(y * CellsLon + x);
+				}
+			}
+		};
+		if (area.lonMin <= area.lonMax)
+		{
+			rows(cellLon(area.lonMin), cellLon(area.lonMax));
+		}
+		else
+		{
+			rows(cellLon(area.lonMin), CellsLon - 1);
+			rows(0, cellLon(area.lonMax));
+		}
+	}
+
+	/// Checks if point is inside area, same conditions as `RuleRegion::insideRegion`.
+	static bool inside(const Area &area, double lon, double lat)
+	{
+		bool inLon;
+		if (area.lonMin <= area.lonMax)
+			inLon = (lon >= area.lonMin && lon < area.lonMax);
+		else
+			inLon = ((lon >= area.lonMin && lon < M_PI*2.0) || (lon >= 0 && lon < area.lonMax));
+
+		bool inLat = (lat >= area.latMin && lat < area.latMax);
+
+		return inLon && inLat;
+	}
+
+public:
+	/// Builds grid for all objects in list.
+	void build(const std::vector<T*> &objects)
+	{
+		std::vector<Area> all;
+		for (auto* obj : objects)
+		{
+			auto* rules = obj->getRules();
+			for (size_t i = 0; i < rules->getLonMin().size(); ++i)
+			{
+				all.push_back(Area{ rules->getLonMin()[i], rules->getLonMax()[i], rules->getLatMin()[i], rules->getLatMax()[i], obj });
+			}
+		}
+
+		// count areas in each cell, then place them keeping order of objects
+		_cells.assign(CellsLon * CellsLat + 1, 0);
+		for (const auto& area : all)
+		{
+			forEachCell(area, [&](int cell){ ++_cells[cell + 1]; });
+		}
+		for (size_t i = 1; i < _cells.size(); ++i)
+		{
+			_cells[i] += _cells[i - 1];
+		}
+		_areas.resize(_cells.back());
+		std::vector<unsigned> next(_cells.begin(), _cells.end() - 1);
+		for (const auto& area : all)
+		{
+			forEachCell(area, [&](int cell){ _areas[next[cell]++] = area; });
+		}
+		_size = objects.size();
+	}
+
+	/// Was grid built for this list?
+	bool isBuilt(const std::vector<T*> &objects) const
+	{
+		return !_cells.empty() && _size == objects.size();
+	}
+
+	/// Finds first object with area containing the point, or null.
+	T *find(double lon, double lat) const
+	{
+		const int cell = cellLat(lat) * CellsLon + cellLon(lon);
+		for (unsigned i = _cells[cell]; i < _cells[cell + 1]; ++i)
+		{
+			if (inside(_areas[i], lon, lat))
+			{
+				return _areas[i].object;
+			}
+		}
+		return nullptr;
+	}
+};
+
+}
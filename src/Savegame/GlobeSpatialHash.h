@@ -0,0 +1,135 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <algorithm>
+#include "../fmath.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Spatial hash of targets on the globe, used to skip pairs of targets that are too far from each other.
+ * Positions are converted to points on unit sphere and put in cubic cells with size of given range.
+ * Finding returns indexes of all objects that could be in range, in same order as in the original list,
+ * caller still need check real distance. Grid need be built again after objects move.
+ */
+template<typename T>
+class GlobeSpatialHash
+{
+	/// Max number of cells on one axis.
+	static constexpr int MaxCells = 64;
+	/// Extra space added to range, covers rounding errors in `Target::getDistance`.
+	static constexpr double Padding = 0.000001;
+
+	/// Object index with its cell, sorted by cell.
+	std::vector<std::pair<unsigned, unsigned>> _entries;
+	/// Number of objects in grid.
+	size_t _size = 0;
+	/// Size of cell.
+	double _cellSize = 2.0;
+	/// Number of cells on one axis.
+	int _cells = 1;
+
+	/// Gets straight line distance between two points on unit sphere that are given great circle distance apart.
+	static double chord(double range)
+	{
+		return range < M_PI ? 2.0 * std::sin(range / 2.0) : 2.0;
+	}
+
+	/// Gets position of point on unit sphere.
+	static void toPoint(double lon, double lat, double (&p)[3])
+	{
+		p[0] = std::cos(lat) * std::cos(lon);
+		p[1] = std::cos(lat) * std::sin(lon);
+		p[2] = std::sin(lat);
+	}
+
+	/// Gets cell on one axis.
+	int cell(double v) const
+	{
+		return Clamp((int)std::floor((v + 1.0) / _cellSize), 0, _cells - 1);
+	}
+
+	/// Gets key of cell.
+	unsigned key(int x, int y, int z) const
+	{
+		return (unsigned)((x * _cells + y) * _cells + z);
+	}
+
+public:
+	/// Builds grid for all objects in list, queries with bigger range than this are slower.
+	void build(const std::vector<T*> &objects, double range)
+	{
+		_cellSize = std::max(chord(range) + Padding, 2.0 / MaxCells);
+		_cells = Clamp((int)std::ceil(2.0 / _cellSize), 1, MaxCells);
+		_size = objects.size();
+		_entries.clear();
+		_entries.reserve(_size);
+		for (size_t i = 0; i < _size; ++i)
+		{
+			double p[3];
+			toPoint(objects[i]->getLongitude(), objects[i]->getLatitude(), p);
+			_entries.push_back(std::make_pair(key(cell(p[0]), cell(p[1]), cell(p[2])), (unsigned)i));
+		}
+		std::sort(_entries.begin(), _entries.end());
+	}
+
+	/// Finds indexes of objects that could be in range of given position.
+	void find(double lon, double lat, double range, std::vector<size_t> &indexes) const
+	{
+		indexes.clear();
+		if (range >= M_PI)
+		{
+			for (size_t i = 0; i < _size; ++i)
+			{
+				indexes.push_back(i);
+			}
+			return;
+		}
+
+		double p[3];
+		toPoint(lon, lat, p);
+		const double r = chord(range) + Padding;
+		int lo[3], hi[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			lo[i] = cell(p[i] - r);
+			hi[i] = cell(p[i] + r);
+		}
+		for (int x = lo[0]; x <= hi[0]; ++x)
+		{
+			for (int y = lo[1]; y <= hi[1]; ++y)
+			{
+				for (int z = lo[2]; z <= hi[2]; ++z)
+				{
+					const unsigned k = key(x, y, z);
+					auto it = std::lower_bound(_entries.begin(), _entries.end(), std::make_pair(k, 0u));
+					for (; it != _entries.end() && it->first == k; ++it)
+					{
+						indexes.push_back(it->second);
+					}
+				}
+			}
+		}
+		std::sort(indexes.begin(), indexes.end());
+	}
+};
+
+}
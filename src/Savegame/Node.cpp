@@ -17,11 +17,26 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "Node.h"
+#include "SerializationHelper.h"
+#include "../Engine/Exception.h"
 
 namespace OpenXcom
 {
 
 
+Node::SerializationKey Node::serializationKey =
+{4, // _id
+ 2, // _pos, three of these
+ 2, // _type
+ 1, // _rank
+ 2, // _flags
+ 2, // _reserved
+ 2, // _priority
+ 1, // one 8-bit bool field
+ 2, // linkCount
+ 4, // _nodeLinks
+};
+
 Node::Node() : _id(0), _segment(0), _type(0), _rank(0), _flags(0), _reserved(0), _priority(0), _allocated(false), _dummy(false)
 {
 
@@ -109,6 +124,93 @@ YAML::Node Node::save() const
 	return node;
 }
 
+/**
+ * Loads the node from binary buffer, fields sizes are taken from key used to save it.
+ * Each field is checked to fit in the buffer before it is read.
+ * @param buffer Pointer to buffer, moved after end of this node.
+ * @param bufferEnd End of data in buffer.
+ * @param serKey Sizes of fields.
+ */
+void Node::loadBinary(Uint8 **buffer, const Uint8 *bufferEnd, const Node::SerializationKey& serKey)
+{
+	auto read = [&](Uint8 size)
+	{
+		if (bufferEnd - *buffer < size)
+		{
+			throw Exception("Binary node data is corrupted");
+		}
+		return unserializeInt(buffer, size);
+	};
+
+	_id = read(serKey._id);
+	_pos.x = read(serKey._pos);
+	_pos.y = read(serKey._pos);
+	_pos.z = read(serKey._pos);
+	_type = read(serKey._type);
+	_rank = read(serKey._rank);
+	_flags = read(serKey._flags);
+	_reserved = read(serKey._reserved);
+	_priority = read(serKey._priority);
+
+	Uint8 boolFields = read(serKey.boolFields);
+	_allocated = (boolFields & 1) ? true : false;
+	_dummy = (boolFields & 2) ? true : false;
+
+	int linkCount = read(serKey.linkCount);
+	if (linkCount < 0 || (size_t)(bufferEnd - *buffer) < (size_t)linkCount * serKey._nodeLinks)
+	{
+		throw Exception("Binary node data is corrupted");
+	}
+	_nodeLinks.clear();
+	_nodeLinks.reserve(linkCount);
+	for (int i = 0; i < linkCount; ++i)
+	{
+		_nodeLinks.push_back(read(serKey._nodeLinks));
+	}
+}
+
+/**
+ * Saves the node to binary buffer.
+ * Throws if node has more links than fit in the size of link count field.
+ * @param buffer Pointer to buffer with at least `getBinarySize()` bytes left, moved after end of this node.
+ */
+void Node::saveBinary(Uint8 **buffer) const
+{
+	serializeInt(buffer, serializationKey._id, _id);
+	serializeInt(buffer, serializationKey._pos, _pos.x);
+	serializeInt(buffer, serializationKey._pos, _pos.y);
+	serializeInt(buffer, serializationKey._pos, _pos.z);
+	serializeInt(buffer, serializationKey._type, _type);
+	serializeInt(buffer, serializationKey._rank, _rank);
+	serializeInt(buffer, serializationKey._flags, _flags);
+	serializeInt(buffer, serializationKey._reserved, _reserved);
+	serializeInt(buffer, serializationKey._priority, _priority);
+
+	Uint8 boolFields = (_allocated ? 1 : 0) + (_dummy ? 2 : 0);
+	serializeInt(buffer, serializationKey.boolFields, boolFields);
+
+	if (_nodeLinks.size() >= (1u << (8 * serializationKey.linkCount - 1)))
+	{
+		throw Exception("Node " + std::to_string(_id) + " has too many links to save: " + std::to_string(_nodeLinks.size()));
+	}
+	serializeInt(buffer, serializationKey.linkCount, (int)_nodeLinks.size());
+	for (int link : _nodeLinks)
+	{
+		serializeInt(buffer, serializationKey._nodeLinks, link);
+	}
+}
+
+/**
+ * Gets number of bytes needed to save the node to binary buffer.
+ * @return Size in bytes.
+ */
+size_t Node::getBinarySize() const
+{
+	return serializationKey._id + 3 * serializationKey._pos + serializationKey._type + serializationKey._rank
+		+ serializationKey._flags + serializationKey._reserved + serializationKey._priority
+		+ serializationKey.boolFields + serializationKey.linkCount + _nodeLinks.size() * serializationKey._nodeLinks;
+}
+
 /**
  * Get the node's id
  * @return unique id
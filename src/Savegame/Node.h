@@ -19,6 +19,7 @@
  */
 #include "../Battlescape/Position.h"
 #include <yaml-cpp/yaml.h>
+#include <SDL_types.h>
 
 namespace OpenXcom
 {
@@ -50,6 +51,24 @@ public:
 	static const int TYPE_SMALL = 0x02; // large unit can not spawn here when this bit is set
 	static const int TYPE_DANGEROUS = 0x04; // an alien was shot here, stop patrolling to it like an idiot with a death wish
 	static const int nodeRank[8][7]; // maps alien ranks to node (.RMP) ranks
+
+	/// Version of binary node format, increase when fields are added or removed.
+	static const int BINARY_VERSION = 1;
+	static struct SerializationKey
+	{
+		// how many bytes to store for each variable or each member of array of the same name
+		Uint8 _id;
+		Uint8 _pos; // three of these
+		Uint8 _type;
+		Uint8 _rank;
+		Uint8 _flags;
+		Uint8 _reserved;
+		Uint8 _priority;
+		Uint8 boolFields;
+		Uint8 linkCount;
+		Uint8 _nodeLinks; // `linkCount` of these
+	} serializationKey;
+
 	/// Creates a Node.
 	Node();
 	Node(int id, Position pos, int segment, int type, int rank, int flags, int reserved, int priority);
@@ -59,6 +78,12 @@ public:
 	void load(const YAML::Node& node);
 	/// Saves the node to YAML.
 	YAML::Node save() const;
+	/// Loads the node from binary buffer.
+	void loadBinary(Uint8 **buffer, const Uint8 *bufferEnd, const Node::SerializationKey& serializationKey);
+	/// Saves the node to binary buffer.
+	void saveBinary(Uint8 **buffer) const;
+	/// Gets number of bytes needed to save the node to binary buffer.
+	size_t getBinarySize() const;
 	/// get the node's id
 	int getID() const;
 	/// get the node's paths
@@ -40,9 +40,11 @@
 #include "../Engine/Sound.h"
 #include "../Mod/RuleInventory.h"
 #include "../Battlescape/AIModule.h"
+#include "../Battlescape/BattleProfiler.h"
 #include "../Engine/RNG.h"
 #include "../Engine/Options.h"
 #include "../Engine/Logger.h"
+#include "../Engine/Exception.h"
 #include "../Engine/ScriptBind.h"
 #include "SerializationHelper.h"
 #include "../Mod/RuleStartingCondition.h"
@@ -234,11 +236,56 @@ void SavedBattleGame::load(const YAML::Node &node, Mod *mod, SavedGame* savedGam
 			calculateModuleMap();
 		}
 	}
-	for (YAML::const_iterator i = node["nodes"].begin(); i != node["nodes"].end(); ++i)
+	if (!node["binNodes"])
 	{
-		Node *n = new Node();
-		n->load(*i);
-		_nodes.push_back(n);
+		for (YAML::const_iterator i = node["nodes"].begin(); i != node["nodes"].end(); ++i)
+		{
+			Node *n = new Node();
+			n->load(*i);
+			_nodes.push_back(n);
+		}
+	}
+	else
+	{
+		int version = node["nodeBinaryVersion"].as<int>(0);
+		if (version != Node::BINARY_VERSION)
+		{
+			throw Exception("Unsupported version " + std::to_string(version) + " of binary node data");
+		}
+
+		// load key to how the node data was saved
+		Node::SerializationKey serKey = Node::serializationKey;
+		serKey._id = node["nodeIDSize"].as<int>(serKey._id);
+		serKey._pos = node["nodePositionSize"].as<int>(serKey._pos);
+		serKey._type = node["nodeTypeSize"].as<int>(serKey._type);
+		serKey._rank = node["nodeRankSize"].as<int>(serKey._rank);
+		serKey._flags = node["nodeFlagsSize"].as<int>(serKey._flags);
+		serKey._reserved = node["nodeReservedSize"].as<int>(serKey._reserved);
+		serKey._priority = node["nodePrioritySize"].as<int>(serKey._priority);
+		serKey.boolFields = node["nodeBoolFieldsSize"].as<int>(serKey.boolFields);
+		serKey.linkCount = node["nodeLinkCountSize"].as<int>(serKey.linkCount);
+		serKey._nodeLinks = node["nodeLinkSize"].as<int>(serKey._nodeLinks);
+		for (Uint8 size : { serKey._id, serKey._pos, serKey._type, serKey._rank, serKey._flags, serKey._reserved, serKey._priority, serKey.boolFields, serKey.linkCount, serKey._nodeLinks })
+		{
+			if (size != 1 && size != 2 && size != 4)
+			{
+				throw Exception("Unsupported field size " + std::to_string(size) + " in binary node data");
+			}
+		}
+
+		// load binary node data!
+		YAML::Binary binNodes = node["binNodes"].as<YAML::Binary>();
+		size_t totalNodes = node["totalNodes"].as<size_t>();
+
+		Uint8 *r = (Uint8*)binNodes.data();
+		Uint8 *dataEnd = r + binNodes.size();
+		_nodes.reserve(totalNodes);
+		for (size_t i = 0; i < totalNodes; ++i)
+		{
+			Node *n = new Node();
+			_nodes.push_back(n);
+			n->loadBinary(&r, dataEnd, serKey);
+		}
 	}
 
 	for (YAML::const_iterator i = node["units"].begin(); i != node["units"].end(); ++i)
@@ -610,14 +657,47 @@ YAML::Node SavedBattleGame::save() const
 	node["binTiles"] = YAML::Binary(tileData, tileDataSize);
 	free(tileData);
 #endif
-	for (std::vector<Node*>::const_iterator i = _nodes.begin(); i != _nodes.end(); ++i)
+	if (Options::oxceReadableBattleSave)
+	{
+		for (std::vector<Node*>::const_iterator i = _nodes.begin(); i != _nodes.end(); ++i)
+		{
+			node["nodes"].push_back((*i)->save());
+		}
+	}
+	else
 	{
-		node["nodes"].push_back((*i)->save());
+		// same as tiles, write out the field sizes and then all nodes in one block
+		node["nodeBinaryVersion"] = Node::BINARY_VERSION;
+		node["nodeIDSize"] = (int)Node::serializationKey._id;
+		node["nodePositionSize"] = (int)Node::serializationKey._pos;
+		node["nodeTypeSize"] = (int)Node::serializationKey._type;
+		node["nodeRankSize"] = (int)Node::serializationKey._rank;
+		node["nodeFlagsSize"] = (int)Node::serializationKey._flags;
+		node["nodeReservedSize"] = (int)Node::serializationKey._reserved;
+		node["nodePrioritySize"] = (int)Node::serializationKey._priority;
+		node["nodeBoolFieldsSize"] = (int)Node::serializationKey.boolFields;
+		node["nodeLinkCountSize"] = (int)Node::serializationKey.linkCount;
+		node["nodeLinkSize"] = (int)Node::serializationKey._nodeLinks;
+
+		size_t nodeDataSize = 0;
+		for (const auto* n : _nodes)
+		{
+			nodeDataSize += n->getBinarySize();
+		}
+		std::vector<Uint8> nodeData(nodeDataSize);
+		Uint8* nw = nodeData.data();
+		for (const auto* n : _nodes)
+		{
+			n->saveBinary(&nw);
+		}
+		node["totalNodes"] = _nodes.size();
+		node["binNodes"] = YAML::Binary(nodeData.data(), nodeDataSize);
 	}
 	if (_missionType == "STR_BASE_DEFENSE")
 	{
 		node["moduleMap"] = _baseModules;
 	}
+	// units, items and AI state are still YAML, only tiles and nodes have binary sections
 	for (std::vector<BattleUnit*>::const_iterator i = _units.begin(); i != _units.end(); ++i)
 	{
 		node["units"].push_back((*i)->save(this->getMod()->getScriptGlobal()));
@@ -695,7 +775,8 @@ void SavedBattleGame::initMap(int mapsize_x, int mapsize_y, int mapsize_z, bool
 	{
 		_tiles.push_back(Tile(getTileCoords(i), this));
 	}
-
+	_terrainVoxels.clear();
+	_terrainVoxels.resize(_tiles.size() * TerrainVoxelRows, 0);
 }
 
 /**
@@ -891,6 +972,73 @@ Position SavedBattleGame::getTileCoords(int index) const
 	return p;
 }
 
+/**
+ * Rebuilds terrain voxel cache of a tile, need be called every time when tile parts change.
+ * Tile above is refreshed too, as grav lift floor depends on the tile below it.
+ * @param tile Tile that changed.
+ */
+void SavedBattleGame::updateTerrainVoxels(const Tile *tile)
+{
+	if (_terrainVoxels.empty())
+	{
+		return;
+	}
+
+	const std::vector<Uint16> *voxelData = _rule->getVoxelData();
+	for (const Tile *t : { tile, getAboveTile(tile) })
+	{
+		if (t == nullptr)
+		{
+			continue;
+		}
+		Uint16 *rows = &_terrainVoxels[getTileIndex(t->getPosition()) * TerrainVoxelRows];
+		std::fill_n(rows, TerrainVoxelRows, 0);
+
+		for (int i = O_FLOOR; i <= O_OBJECT; ++i)
+		{
+			const TilePart tp = (TilePart)i;
+			const MapData *mp = t->getMapData(tp);
+			if (mp == nullptr || (((tp == O_WESTWALL) || (tp == O_NORTHWALL)) && t->isUfoDoorOpen(tp)))
+			{
+				continue;
+			}
+			for (int layer = 0; layer < TerrainVoxelLayers; ++layer)
+			{
+				const size_t idx = mp->getLoftID(layer) * Position::TileXY;
+				for (int y = 0; y < Position::TileXY; ++y)
+				{
+					// broken LOFT index, let `voxelCheck` handle it like before
+					rows[layer * Position::TileXY + y] |= idx + y < voxelData->size() ? voxelData->at(idx + y) : 0xFFFF;
+				}
+			}
+		}
+
+		// grav lift act like solid floor in lowest layer
+		const Tile *below = getBelowTile(t);
+		if (t->getMapData(O_FLOOR) && t->getMapData(O_FLOOR)->isGravLift())
+		{
+			if ((t->getPosition().z == 0) || (below && below->getMapData(O_FLOOR) && !below->getMapData(O_FLOOR)->isGravLift()))
+			{
+				std::fill_n(rows, Position::TileXY, 0xFFFF);
+			}
+		}
+	}
+}
+
+/**
+ * Refreshes all data cached from terrain of a tile, need be called
+ * every time map data or door state of tile change.
+ * @param tile Tile that changed.
+ */
+void SavedBattleGame::updateTerrainCache(const Tile *tile)
+{
+	updateTerrainVoxels(tile);
+	if (_pathfinding)
+	{
+		_pathfinding->invalidateTransitions(tile->getPosition());
+	}
+}
+
 /**
  * Gets the currently selected unit
  * @return Pointer to BattleUnit.
@@ -1455,6 +1603,14 @@ const RuleCraftDeployment& SavedBattleGame::getCustomDeployment(const RuleCraft*
  */
 void SavedBattleGame::endTurn()
 {
+	BattleProfiler::endTurn(_turn, _side);
+
+	// terrain cache is refreshed every turn, in case something was missed.
+	if (_pathfinding)
+	{
+		_pathfinding->clearTransitions();
+	}
+
 	// reset turret direction for all hostile and neutral units (as it may have been changed during reaction fire)
 	for (std::vector<BattleUnit*>::iterator i = _units.begin(); i != _units.end(); ++i)
 	{
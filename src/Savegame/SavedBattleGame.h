@@ -62,6 +62,11 @@ public:
 	/// Register all useful function used by script.
 	static void ScriptRegister(ScriptParserBase* parser);
 
+	/// Number of voxel layers stored per tile in terrain cache, same resolution as LOFT data.
+	static constexpr int TerrainVoxelLayers = Position::TileZ / 2;
+	/// Number of voxel rows stored per tile in terrain cache.
+	static constexpr int TerrainVoxelRows = TerrainVoxelLayers * Position::TileXY;
+
 private:
 	bool _isPreview;
 	SDL_Rect _craftPos;
@@ -73,6 +78,7 @@ private:
 	int _mapsize_x, _mapsize_y, _mapsize_z;
 	std::vector<MapDataSet*> _mapDataSets;
 	std::vector<Tile> _tiles;
+	std::vector<Uint16> _terrainVoxels;
 	BattleUnit *_selectedUnit, *_lastSelectedUnit;
 	std::vector<Node*> _nodes;
 	std::vector<BattleUnit*> _units;
@@ -250,6 +256,25 @@ public:
 	/// Converts a tile index to its coordinates.
 	Position getTileCoords(int index) const;
 
+	/// Rebuilds terrain voxel cache of a tile after its terrain changed.
+	void updateTerrainVoxels(const Tile *tile);
+	/// Refreshes all data cached from terrain of a tile after it changed.
+	void updateTerrainCache(const Tile *tile);
+
+	/**
+	 * Checks if terrain of a tile can occupy a given voxel.
+	 * Set bit only means that `TileEngine::voxelCheck` needs to check tile parts,
+	 * cleared bit guarantees that terrain does not block this voxel.
+	 * @param tileIndex Index of tile that contains the voxel.
+	 * @param voxel Voxel position.
+	 * @return True if terrain occupies the voxel.
+	 */
+	inline bool isTerrainVoxel(int tileIndex, Position voxel) const
+	{
+		const int row = tileIndex * TerrainVoxelRows + ((voxel.z % Position::TileZ) / 2) * Position::TileXY + voxel.y % Position::TileXY;
+		return _terrainVoxels[row] & (1 << (Position::TileXY - 1 - voxel.x % Position::TileXY));
+	}
+
 	/**
 	 * Gets the Tile at a given position on the map.
 	 * This method is called over 50mil+ times per turn so it seems useful
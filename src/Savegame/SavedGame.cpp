@@ -119,6 +119,11 @@ bool researchLess(const RuleResearch *a, const RuleResearch *b)
 	return std::less<const RuleResearch *>{}(a, b);
 }
 
+bool researchNameLess(const RuleResearch *a, const RuleResearch *b)
+{
+	return a->getName() < b->getName();
+}
+
 template<typename T>
 void sortReserchVector(std::vector<T> &vec)
 {
@@ -131,10 +136,13 @@ bool haveReserchVector(const std::vector<const RuleResearch*> &vec, const RuleRe
 	return find != vec.end() && *find == res;
 }
 
+/**
+ * Finds research by name, vector need be ordered by `researchNameLess`.
+ */
 bool haveReserchVector(const std::vector<const RuleResearch*> &vec,  const std::string &res)
 {
-	auto find = std::find_if(vec.begin(), vec.end(), [&](const RuleResearch* r){ return r->getName() == res; });
-	return find != vec.end();
+	auto find = std::lower_bound(vec.begin(), vec.end(), res, [](const RuleResearch* r, const std::string &name){ return r->getName() < name; });
+	return find != vec.end() && (*find)->getName() == res;
 }
 
 }
@@ -601,7 +609,7 @@ void SavedGame::load(const std::string &filename, Mod *mod, Language *lang)
 			Log(LOG_ERROR) << "Failed to load research " << research;
 		}
 	}
-	sortReserchVector(_discovered);
+	sortDiscoveredResearch();
 
 	_generatedEvents = doc["generatedEvents"].as< std::map<std::string, int> >(_generatedEvents);
 	_ufopediaRuleStatus = doc["ufopediaRuleStatus"].as< std::map<std::string, int> >(_ufopediaRuleStatus);
@@ -1572,6 +1580,16 @@ const RuleResearch* SavedGame::selectGetOneFree(const RuleResearch* research)
 	return nullptr;
 }
 
+/**
+ * Sorts discovered research for lookups by rule, and updates copy ordered by name for lookups by name.
+ */
+void SavedGame::sortDiscoveredResearch()
+{
+	sortReserchVector(_discovered);
+	_discoveredByName = _discovered;
+	std::sort(_discoveredByName.begin(), _discoveredByName.end(), researchNameLess);
+}
+
 /*
  * Checks for and removes a research project from the "already discovered" list
  * @param research is the project we are checking for and removing, if necessary.
@@ -1582,6 +1600,7 @@ void SavedGame::removeDiscoveredResearch(const RuleResearch * research)
 	if (r != _discovered.end())
 	{
 		_discovered.erase(r);
+		sortDiscoveredResearch();
 	}
 }
 
@@ -1592,7 +1611,7 @@ void SavedGame::removeDiscoveredResearch(const RuleResearch * research)
 void SavedGame::addFinishedResearchSimple(const RuleResearch * research)
 {
 	_discovered.push_back(research);
-	sortReserchVector(_discovered);
+	sortDiscoveredResearch();
 }
 
 /**
@@ -1636,7 +1655,7 @@ void SavedGame::addFinishedResearch(const RuleResearch * research, const Mod * m
 		if (!isResearched(currentQueueItem, false))
 		{
 			_discovered.push_back(currentQueueItem);
-			sortReserchVector(_discovered);
+			sortDiscoveredResearch();
 			if (!hasUndiscoveredProtectedUnlocks && !hasAnyUndiscoveredGetOneFrees)
 			{
 				// If the currentQueueItem can't tell you anything anymore, remove it from popped research
@@ -2175,7 +2194,7 @@ bool SavedGame::isResearched(const std::string &research, bool considerDebugMode
 	if (considerDebugMode && _debug)
 		return true;
 
-	return haveReserchVector(_discovered, research);
+	return haveReserchVector(_discoveredByName, research);
 }
 
 bool SavedGame::isResearched(const RuleResearch *research, bool considerDebugMode) const
@@ -2197,7 +2216,7 @@ bool SavedGame::isResearched(const std::vector<std::string> &research, bool cons
 
 	for (const std::string &r : research)
 	{
-		if (!haveReserchVector(_discovered, r))
+		if (!haveReserchVector(_discoveredByName, r))
 		{
 			return false;
 		}
@@ -2688,22 +2707,21 @@ void SavedGame::setWarned(bool warned)
 	_warned = warned;
 }
 
-/** @brief Check if a point is contained in a region.
- * This function object checks if a point is contained inside a region.
+/**
+ * Find the region containing this location.
+ * Uses grid of region areas, rebuilt when list of regions changes.
+ * @param lon The longitude.
+ * @param lat The latitude.
+ * @return Pointer to the region, or 0.
  */
-class ContainsPoint
+Region *SavedGame::findRegion(double lon, double lat) const
 {
-	typedef const Region* argument_type;
-	typedef bool result_type;
-
-public:
-	/// Remember the coordinates.
-	ContainsPoint(double lon, double lat) : _lon(lon), _lat(lat) { /* Empty by design. */ }
-	/// Check is the region contains the stored point.
-	bool operator()(const Region *region) const { return region->getRules()->insideRegion(_lon, _lat); }
-private:
-	double _lon, _lat;
-};
+	if (!_regionIndex.isBuilt(_regions))
+	{
+		_regionIndex.build(_regions);
+	}
+	return _regionIndex.find(lon, lat);
+}
 
 /**
  * Find the region containing this location.
@@ -2713,10 +2731,10 @@ private:
  */
 Region *SavedGame::locateRegion(double lon, double lat) const
 {
-	std::vector<Region *>::const_iterator found = std::find_if (_regions.begin(), _regions.end(), ContainsPoint(lon, lat));
-	if (found != _regions.end())
+	Region *found = findRegion(lon, lat);
+	if (found)
 	{
-		return *found;
+		return found;
 	}
 	Log(LOG_ERROR) << "Failed to find a region at location [" << lon << ", " << lat << "].";
 	return 0;
@@ -2732,22 +2750,21 @@ Region *SavedGame::locateRegion(const Target &target) const
 	return locateRegion(target.getLongitude(), target.getLatitude());
 }
 
-/** @brief Check if a point is contained in a country.
- * This function object checks if a point is contained inside a country.
+/**
+ * Find the country containing this location.
+ * Uses grid of country areas, rebuilt when list of countries changes.
+ * @param lon The longitude.
+ * @param lat The latitude.
+ * @return Pointer to the country, or 0.
  */
-class CountryContainsPoint
+Country *SavedGame::findCountry(double lon, double lat) const
 {
-	typedef const Country* argument_type;
-	typedef bool result_type;
-
-public:
-	/// Remember the coordinates.
-	CountryContainsPoint(double lon, double lat) : _lon(lon), _lat(lat) { /* Empty by design. */ }
-	/// Check if the country contains the stored point.
-	bool operator()(const Country* country) const { return country->getRules()->insideCountry(_lon, _lat); }
-private:
-	double _lon, _lat;
-};
+	if (!_countryIndex.isBuilt(_countries))
+	{
+		_countryIndex.build(_countries);
+	}
+	return _countryIndex.find(lon, lat);
+}
 
 /**
  * Find the country containing this location.
@@ -2757,13 +2774,7 @@ private:
  */
 Country* SavedGame::locateCountry(double lon, double lat) const
 {
-	std::vector<Country*>::const_iterator found = std::find_if(_countries.begin(), _countries.end(), CountryContainsPoint(lon, lat));
-	if (found != _countries.end())
-	{
-		return *found;
-	}
-	//Log(LOG_DEBUG) << "Failed to find a country at location [" << lon << ", " << lat << "].";
-	return 0;
+	return findCountry(lon, lat);
 }
 
 /**
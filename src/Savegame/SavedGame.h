@@ -31,6 +31,7 @@
 #include "../Mod/RuleBaseFacility.h"
 #include "../Mod/RuleCraft.h"
 #include "../Engine/Script.h"
+#include "GlobeAreaIndex.h"
 
 namespace OpenXcom
 {
@@ -143,6 +144,8 @@ private:
 	std::map<std::string, int> _ids;
 	std::vector<Country*> _countries;
 	std::vector<Region*> _regions;
+	mutable GlobeAreaIndex<Country> _countryIndex;
+	mutable GlobeAreaIndex<Region> _regionIndex;
 	std::vector<Base*> _bases;
 	std::vector<Ufo*> _ufos;
 	std::vector<Waypoint*> _waypoints;
@@ -151,6 +154,7 @@ private:
 	AlienStrategy *_alienStrategy;
 	SavedBattleGame *_battleGame;
 	std::vector<const RuleResearch*> _discovered;
+	std::vector<const RuleResearch*> _discoveredByName; // same as `_discovered` but ordered by name
 	std::map<std::string, int> _generatedEvents;
 	std::map<std::string, int> _ufopediaRuleStatus;
 	std::map<std::string, int> _manufactureRuleStatus;
@@ -185,6 +189,8 @@ private:
 	ScriptValues<SavedGame> _scriptValues;
 
 	static SaveInfo getSaveInfo(const std::string &file, Language *lang);
+	/// Sorts discovered research and updates its name index.
+	void sortDiscoveredResearch();
 public:
 	static const std::string AUTOSAVE_GEOSCAPE, AUTOSAVE_BATTLESCAPE, QUICKSAVE;
 	/// Creates a new saved game.
@@ -409,6 +415,21 @@ public:
 	std::vector<GeoscapeEvent*> &getGeoscapeEvents() { return _geoscapeEvents; }
 	/// Read-only access to the current geoscape events.
 	const std::vector<GeoscapeEvent*> &getGeoscapeEvents() const { return _geoscapeEvents; }
+	/// Find a region containing a position, without logging missing one.
+	Region *findRegion(double lon, double lat) const;
+	/// Find a country containing a position.
+	Country *findCountry(double lon, double lat) const;
+	/// Locate regions and countries of a list of targets at once.
+	template<typename T>
+	void locateAreas(const std::vector<T*> &targets, std::vector<std::pair<Region*, Country*>> &areas) const
+	{
+		areas.clear();
+		areas.reserve(targets.size());
+		for (auto* target : targets)
+		{
+			areas.push_back(std::make_pair(findRegion(target->getLongitude(), target->getLatitude()), findCountry(target->getLongitude(), target->getLatitude())));
+		}
+	}
 	/// Locate a region containing a position.
 	Region *locateRegion(double lon, double lat) const;
 	/// Locate a region containing a Target.
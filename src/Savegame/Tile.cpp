@@ -249,6 +249,7 @@ void Tile::setMapData(MapData *dat, int mapDataID, int mapDataSetID, TilePart pa
 		_cache.terrainLevel = level;
 	}
 	updateSprite(part);
+	_save->updateTerrainCache(this);
 }
 
 /**
@@ -377,6 +378,7 @@ int Tile::openDoor(TilePart part, BattleUnit *unit, BattleActionType reserve, bo
 			return 4;
 		_objectsCache[part].currentFrame = 1; // start opening door
 		updateSprite((TilePart)part);
+		_save->updateTerrainCache(this);
 		return 1;
 	}
 	if (_objectsCache[part].isUfoDoor && _objectsCache[part].currentFrame != 7) // ufo door != part 7 - door is still opening
@@ -399,6 +401,10 @@ int Tile::closeUfoDoor()
 			updateSprite((TilePart)part);
 		}
 	}
+	if (retval)
+	{
+		_save->updateTerrainCache(this);
+	}
 
 	return retval;
 }
@@ -695,6 +701,11 @@ void Tile::animate()
 				newframe = 0;
 			}
 			_objectsCache[i].currentFrame = newframe;
+			if (_objectsCache[i].isUfoDoor && newframe == 2)
+			{
+				// opening door stop costing TU from this frame
+				_save->updateTerrainCache(this);
+			}
 		}
 		updateSprite((TilePart)i);
 	}